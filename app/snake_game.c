@@ -99,8 +99,7 @@ static void snake_game_render_callback(Canvas* const canvas, void* ctx) {
         canvas_set_font(canvas, FontSecondary);
         char buffer[12];
         snprintf(buffer, sizeof(buffer), "Score: %u", snake_state->len - 7);
-        // canvas_draw_str_aligned(canvas, 64, 41, buffer);
-        canvas_draw_str(canvas, 49, 41, buffer);
+        canvas_draw_str_aligned(canvas, 64, 41, AlignCenter, AlignBottom, buffer);
     }
 
     release_mutex((ValueMutex*)ctx, snake_state);
@@ -0,0 +1,711 @@
+#include <gui/canvas.h>
+#include <gui/canvas_i.h>
+#include <hal/display.h>
+#include <hal/display_expand.h>
+#include <hal/display_transfer.h>
+#include <gui/elements.h>
+#include <gui/icon_i.h>
+#include <gui/icon_animation_i.h>
+#include <applications/gui/font/fonts.h>
+#include <applications/gui/icon_cache.h>
+#include <applications/gui/text_layout_cache.h>
+#include <bitset>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utility>
+
+// Per-pixel bitset framebuffer, kept as the baseline to compare against
+class ReferenceCanvas {
+private:
+    std::bitset<DISPLAY_WIDTH * DISPLAY_HEIGHT> display_buffer;
+
+public:
+    void fill(bool value) {
+        if(value) {
+            display_buffer.set();
+        } else {
+            display_buffer.reset();
+        }
+    }
+
+    void set_pixel(size_t x, size_t y) {
+        if(x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
+            display_buffer.set(x + y * DISPLAY_WIDTH, true);
+        }
+    }
+
+    void draw_horizontal_line(uint16_t x, uint16_t y, uint16_t length) {
+        for(uint16_t i = 0; i < length; i++) {
+            set_pixel(x + i, y);
+        }
+    }
+
+    void draw_box(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        for(uint8_t i = 0; i < height; i++) {
+            draw_horizontal_line(x, y + i, width);
+        }
+    }
+
+    void invert_box(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        for(size_t j = y; j < (size_t)y + height && j < DISPLAY_HEIGHT; j++) {
+            for(size_t i = x; i < (size_t)x + width && i < DISPLAY_WIDTH; i++) {
+                display_buffer.flip(i + j * DISPLAY_WIDTH);
+            }
+        }
+    }
+
+    void draw_xbm(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* bitmap, bool alpha) {
+        size_t stride = (w + 7) / 8;
+        for(uint8_t j = 0; j < h; j++) {
+            for(uint8_t i = 0; i < w; i++) {
+                bool pixel = (bitmap[j * stride + i / 8] >> (i % 8)) & 1;
+                if(pixel || !alpha) {
+                    size_t px = x + i;
+                    size_t py = y + j;
+                    if(px < DISPLAY_WIDTH && py < DISPLAY_HEIGHT) {
+                        display_buffer.set(px + py * DISPLAY_WIDTH, pixel);
+                    }
+                }
+            }
+        }
+    }
+
+    // Per-pixel u8g2_DrawLine
+    void draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+        int dx = abs(x2 - x1);
+        int dy = abs(y2 - y1);
+        bool swapxy = dy > dx;
+        if(swapxy) {
+            std::swap(dx, dy);
+            std::swap(x1, y1);
+            std::swap(x2, y2);
+        }
+        if(x1 > x2) {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+        }
+        int err = dx >> 1;
+        int ystep = y2 > y1 ? 1 : -1;
+        uint8_t y = y1;
+        for(int x = x1; x <= x2; x++) {
+            if(swapxy) {
+                set_pixel(y, x);
+            } else {
+                set_pixel(x, y);
+            }
+            err -= dy;
+            if(err < 0) {
+                y += ystep;
+                err += dx;
+            }
+        }
+    }
+
+    void draw_vertical_line(int x, int y, int length) {
+        for(int i = 0; i < length; i++) {
+            if(x >= 0 && y + i >= 0) {
+                set_pixel(x, y + i);
+            }
+        }
+    }
+
+    // u8g2_DrawDisc: every midpoint step fills two columns per quadrant, rows get overdrawn
+    void draw_disc(int x0, int y0, uint8_t rad, uint8_t option) {
+        int x = 0;
+        int y = rad;
+        int f = 1 - rad;
+        int ddF_x = 1;
+        int ddF_y = -2 * rad;
+        while(true) {
+            if(option & 1) {
+                draw_vertical_line(x0 + x, y0 - y, y + 1);
+                draw_vertical_line(x0 + y, y0 - x, x + 1);
+            }
+            if(option & 2) {
+                draw_vertical_line(x0 - x, y0 - y, y + 1);
+                draw_vertical_line(x0 - y, y0 - x, x + 1);
+            }
+            if(option & 4) {
+                draw_vertical_line(x0 - x, y0, y + 1);
+                draw_vertical_line(x0 - y, y0, x + 1);
+            }
+            if(option & 8) {
+                draw_vertical_line(x0 + x, y0, y + 1);
+                draw_vertical_line(x0 + y, y0, x + 1);
+            }
+            if(x >= y) break;
+            if(f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+        }
+    }
+
+    // u8g2_DrawRBox: four disc quadrants and three boxes
+    void draw_rbox(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+        int xl = x + r;
+        int yu = y + r;
+        int xr = x + w - r - 1;
+        int yl = y + h - r - 1;
+        draw_disc(xl, yu, r, 2);
+        draw_disc(xr, yu, r, 1);
+        draw_disc(xl, yl, r, 4);
+        draw_disc(xr, yl, r, 8);
+        if(w - 2 * r >= 3) {
+            draw_box(xl + 1, y, w - 2 * r - 2, r + 1);
+            draw_box(xl + 1, yl, w - 2 * r - 2, r + 1);
+        }
+        if(h - 2 * r >= 3) {
+            draw_box(x, yu + 1, w, h - 2 * r - 2);
+        }
+    }
+
+    bool get_pixel(size_t x, size_t y) {
+        return display_buffer.test(x + y * DISPLAY_WIDTH);
+    }
+};
+
+// Per-pixel conversion to the u8g2 page layout
+static void reference_pages(ReferenceCanvas& reference, uint8_t* pages) {
+    for(size_t page = 0; page < DISPLAY_HEIGHT / 8; page++) {
+        for(size_t x = 0; x < DISPLAY_WIDTH; x++) {
+            uint8_t byte = 0;
+            for(size_t i = 0; i < 8; i++) {
+                byte |= reference.get_pixel(x, page * 8 + i) << i;
+            }
+            pages[page * DISPLAY_WIDTH + x] = byte;
+        }
+    }
+}
+
+static void reference_span(uint8_t x, uint8_t y, uint8_t length, void* context) {
+}
+
+// u8g2 string width, decoding every glyph to get its metrics
+static uint16_t reference_string_width(const uint8_t* font, const char* text) {
+    U8G2FontRender_t render =
+        U8G2FontRender(font_get_index(font), reference_span, reference_span, NULL);
+    int width = 0;
+    int pitch = 0;
+    U8G2FontGlyph_t last = {};
+    while(*text) {
+        U8G2FontGlyph_t glyph;
+        pitch = 0;
+        if(U8G2FontRender_DecodeGlyph(
+               &render, U8G2FontRender_NextCodePoint(&text), &glyph) == U8G2FontRender_OK) {
+            pitch = glyph.pitch;
+            last = glyph;
+        }
+        width += pitch;
+    }
+    if(last.width) {
+        width += last.width + last.x_offset - pitch;
+    }
+    return width;
+}
+
+// Greedy heatshrink encoder with the window and lookahead of firmware assets, makes test icons
+static std::vector<uint8_t> compress_icon(const std::vector<uint8_t>& data) {
+    const size_t window = 1 << 8;
+    const size_t lookahead = 1 << 4;
+    std::vector<uint8_t> stream;
+    size_t bits = 0;
+    auto put = [&](unsigned value, size_t count) {
+        for(size_t i = count; i-- > 0; bits++) {
+            if(bits % 8 == 0) stream.push_back(0);
+            stream.back() |= ((value >> i) & 1) << (7 - bits % 8);
+        }
+    };
+
+    for(size_t position = 0; position < data.size();) {
+        size_t best_length = 0;
+        size_t best_offset = 0;
+        for(size_t offset = 1; offset <= std::min(window, position); offset++) {
+            size_t length = 0;
+            while(length < lookahead && position + length < data.size() &&
+                  data[position + length] == data[position + length - offset]) {
+                length++;
+            }
+            if(length > best_length) {
+                best_length = length;
+                best_offset = offset;
+            }
+        }
+        // A backref costs 13 bits, a literal 9
+        if(best_length >= 2) {
+            put(0, 1);
+            put(best_offset - 1, 8);
+            put(best_length - 1, 4);
+            position += best_length;
+        } else {
+            put(1, 1);
+            put(data[position++], 8);
+        }
+    }
+
+    std::vector<uint8_t> icon = {1, 0, (uint8_t)stream.size(), (uint8_t)(stream.size() >> 8)};
+    icon.insert(icon.end(), stream.begin(), stream.end());
+    return icon;
+}
+
+// Per-pixel RGB888 expansion as the display widget used to do it, scaled by block writes
+static void reference_expand(const DisplayFrame* frame, size_t scale, uint8_t* image) {
+    size_t stride = DISPLAY_WIDTH * scale * 3;
+    for(size_t y = 0; y < DISPLAY_HEIGHT * scale; y++) {
+        for(size_t x = 0; x < DISPLAY_WIDTH * scale; x++) {
+            size_t px = x / scale;
+            uint8_t* pixel = image + y * stride + x * 3;
+            if((frame->rows[y / scale][px / 64] >> (px % 64)) & 1) {
+                pixel[0] = 0x00;
+                pixel[1] = 0x00;
+                pixel[2] = 0x00;
+            } else {
+                pixel[0] = 0xFF;
+                pixel[1] = 0x82;
+                pixel[2] = 0x00;
+            }
+        }
+    }
+}
+
+static volatile bool bench_sink;
+
+static double bench_run(size_t iterations, std::function<void(size_t)> body) {
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// Pixel of the u8g2 page buffer
+static bool page_pixel(const uint8_t* pages, size_t x, size_t y) {
+    return (pages[y / 8 * DISPLAY_WIDTH + x] >> (y % 8)) & 1;
+}
+
+// Draws a scene on both canvases and compares every pixel, the reference drawing in view port
+// coordinates
+static bool bench_check(
+    const char* name,
+    ReferenceCanvas& reference,
+    Canvas* canvas,
+    const std::function<void(size_t)>& reference_body,
+    const std::function<void(size_t)>& canvas_body) {
+    reference.fill(false);
+    canvas_clear(canvas);
+    for(size_t i = 0; i < 64; i++) {
+        reference_body(i);
+        canvas_body(i);
+    }
+
+    CanvasOrientation orientation = canvas_get_orientation(canvas);
+    const uint8_t* pages = canvas_get_buffer(canvas);
+    size_t mismatches = 0;
+    for(size_t y = 0; y < DISPLAY_HEIGHT; y++) {
+        for(size_t x = 0; x < DISPLAY_WIDTH; x++) {
+            // Vertical maps view port x, y to screen y, 63 - x
+            bool expected = orientation == CanvasOrientationVertical ?
+                                x < DISPLAY_HEIGHT &&
+                                    reference.get_pixel(DISPLAY_HEIGHT - 1 - y, x) :
+                                reference.get_pixel(x, y);
+            if(page_pixel(pages, x, y) != expected && mismatches++ == 0) {
+                printf("%s: mismatch at %zu, %zu\n", name, x, y);
+            }
+        }
+    }
+    if(mismatches) {
+        printf("%s: %zu pixels differ from the reference\n", name, mismatches);
+    }
+    return mismatches == 0;
+}
+
+static void bench_report(
+    const char* name,
+    size_t iterations,
+    size_t pixels_per_op,
+    double reference_time,
+    double canvas_time) {
+    double pixels = (double)iterations * pixels_per_op;
+    printf(
+        "%-12s %10.1f Mpx/s -> %10.1f Mpx/s (x%.1f)\n",
+        name,
+        pixels / reference_time / 1e6,
+        pixels / canvas_time / 1e6,
+        reference_time / canvas_time);
+}
+
+int main(int argc, char** argv) {
+    const size_t iterations = 200000;
+    ReferenceCanvas reference;
+    Canvas* canvas = canvas_init();
+    canvas_frame_set(canvas, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+
+    printf("%-12s %17s    %17s\n", "primitive", "bitset", "word-packed");
+
+    // Scenes drawn the same on both, checked pixel for pixel before timing
+    bool mismatch = false;
+    auto bench_scene = [&](const char* name,
+                           size_t pixels_per_op,
+                           const std::function<void(size_t)>& reference_body,
+                           const std::function<void(size_t)>& canvas_body) {
+        mismatch |= !bench_check(name, reference, canvas, reference_body, canvas_body);
+        double reference_time = bench_run(iterations, reference_body);
+        double canvas_time = bench_run(iterations, canvas_body);
+        bench_report(name, iterations, pixels_per_op, reference_time, canvas_time);
+    };
+
+    // A line dirties every row, so each clear has the whole frame to zero
+    bench_scene(
+        "clear",
+        DISPLAY_WIDTH * DISPLAY_HEIGHT,
+        [&](size_t i) {
+            reference.draw_line(0, i % 8, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1 - i % 8);
+            bench_sink = reference.get_pixel(i % DISPLAY_WIDTH, i % DISPLAY_HEIGHT);
+            reference.fill(false);
+        },
+        [&](size_t i) {
+            canvas_draw_line(canvas, 0, i % 8, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1 - i % 8);
+            canvas_clear(canvas);
+        });
+
+    bench_scene(
+        "hline",
+        DISPLAY_WIDTH - 8,
+        [&](size_t i) {
+            reference.draw_horizontal_line(i % 8, i % DISPLAY_HEIGHT, DISPLAY_WIDTH - 8);
+            bench_sink = reference.get_pixel(64, i % DISPLAY_HEIGHT);
+        },
+        [&](size_t i) {
+            canvas_draw_box(canvas, i % 8, i % DISPLAY_HEIGHT, DISPLAY_WIDTH - 8, 1);
+        });
+
+    bench_scene(
+        "box",
+        100 * 40,
+        [&](size_t i) {
+            reference.draw_box(i % 16, i % 16, 100, 40);
+            bench_sink = reference.get_pixel(64, 32);
+        },
+        [&](size_t i) { canvas_draw_box(canvas, i % 16, i % 16, 100, 40); });
+
+    bench_scene(
+        "small box",
+        6 * 6,
+        [&](size_t i) {
+            reference.draw_box(i % 8, i % 8, 6, 6);
+            bench_sink = reference.get_pixel(4, 4);
+        },
+        [&](size_t i) { canvas_draw_box(canvas, i % 8, i % 8, 6, 6); });
+
+    // Menu selection highlight
+    canvas_set_color(canvas, ColorXOR);
+    bench_scene(
+        "xor box",
+        120 * 12,
+        [&](size_t i) {
+            reference.invert_box(i % 8, i % 48, 120, 12);
+            bench_sink = reference.get_pixel(64, 32);
+        },
+        [&](size_t i) { canvas_draw_box(canvas, i % 8, i % 48, 120, 12); });
+    canvas_set_color(canvas, ColorBlack);
+
+    uint8_t icon[10 * 32];
+    for(size_t i = 0; i < sizeof(icon); i++) {
+        icon[i] = i * 37;
+    }
+    for(bool alpha : {false, true}) {
+        canvas_set_bitmap_mode(canvas, alpha);
+        bench_scene(
+            alpha ? "xbm alpha" : "xbm",
+            75 * 32,
+            [&](size_t i) {
+                reference.draw_xbm(i % 53, i % 29, 75, 32, icon, alpha);
+                bench_sink = reference.get_pixel(64, 32);
+            },
+            [&](size_t i) { canvas_draw_xbm(canvas, i % 53, i % 29, 75, 32, icon); });
+    }
+    canvas_set_bitmap_mode(canvas, false);
+
+    // Graph style polyline: mostly shallow segments with a few steep ones
+    const size_t line_points = DISPLAY_WIDTH / 8;
+    uint8_t line_y[64][line_points + 1];
+    for(size_t i = 0; i < 64; i++) {
+        for(size_t j = 0; j <= line_points; j++) {
+            line_y[i][j] = (j * 7 + i * 13) % 40 + (j % 3) * 8;
+        }
+    }
+    bench_scene(
+        "polyline",
+        DISPLAY_WIDTH,
+        [&](size_t i) {
+            const uint8_t* y = line_y[i % 64];
+            for(size_t j = 0; j < line_points; j++) {
+                reference.draw_line(j * 8, y[j], j * 8 + 8, y[j + 1]);
+            }
+            bench_sink = reference.get_pixel(64, 32);
+        },
+        [&](size_t i) {
+            const uint8_t* y = line_y[i % 64];
+            for(size_t j = 0; j < line_points; j++) {
+                canvas_draw_line(canvas, j * 8, y[j], j * 8 + 8, y[j + 1]);
+            }
+        });
+
+    bench_scene(
+        "long line",
+        DISPLAY_WIDTH,
+        [&](size_t i) {
+            reference.draw_line(
+                0, i % DISPLAY_HEIGHT, DISPLAY_WIDTH - 1, (i * 7) % DISPLAY_HEIGHT);
+            bench_sink = reference.get_pixel(64, 32);
+        },
+        [&](size_t i) {
+            canvas_draw_line(
+                canvas, 0, i % DISPLAY_HEIGHT, DISPLAY_WIDTH - 1, (i * 7) % DISPLAY_HEIGHT);
+        });
+
+    bench_scene(
+        "disc",
+        1257,
+        [&](size_t i) {
+            reference.draw_disc(32 + i % 64, 32, 20, 15);
+            bench_sink = reference.get_pixel(64, 32);
+        },
+        [&](size_t i) { canvas_draw_disc(canvas, 32 + i % 64, 32, 20); });
+
+    bench_scene(
+        "rbox",
+        100 * 40,
+        [&](size_t i) {
+            reference.draw_rbox(i % 16, i % 16, 100, 40, 6);
+            bench_sink = reference.get_pixel(64, 32);
+        },
+        [&](size_t i) { canvas_draw_rbox(canvas, i % 16, i % 16, 100, 40, 6); });
+
+    // Vertical view ports draw through the transposed writers
+    canvas_set_orientation(canvas, CanvasOrientationVertical);
+    bench_scene(
+        "box vert",
+        40 * 40,
+        [&](size_t i) {
+            reference.draw_box(i % 16, i % 16, 40, 40);
+            bench_sink = reference.get_pixel(32, 32);
+        },
+        [&](size_t i) { canvas_draw_box(canvas, i % 16, i % 16, 40, 40); });
+
+    bench_scene(
+        "xbm vert",
+        48 * 32,
+        [&](size_t i) {
+            reference.draw_xbm(i % 7, i % 29, 48, 32, icon, false);
+            bench_sink = reference.get_pixel(32, 32);
+        },
+        [&](size_t i) { canvas_draw_xbm(canvas, i % 7, i % 29, 48, 32, icon); });
+    canvas_set_orientation(canvas, CanvasOrientationHorizontal);
+
+
+    // Menu item measured for centering
+    const char* label = "Bluetooth Settings";
+    canvas_set_font(canvas, FontSecondary);
+    uint16_t label_width = canvas_string_width(canvas, label);
+    double reference_time = bench_run(iterations, [&](size_t i) {
+        bench_sink = reference_string_width(u8g2_font_haxrcorp4089_tr, label) == label_width;
+    });
+    double canvas_time = bench_run(iterations, [&](size_t i) {
+        bench_sink = canvas_string_width(canvas, label) == label_width;
+    });
+    bench_report("str width", iterations, label_width, reference_time, canvas_time);
+
+    // Scrolling text view redrawn every frame, word wrapped from scratch and from the cache
+    const char* article =
+        "Sub-GHz: the radio module can receive and transmit signals in the 300-348, 387-464 and "
+        "779-928 MHz bands. Frequencies outside of these ranges are blocked by the region "
+        "settings.\nInfrared: learns remotes and replays them, with a library of common TV and "
+        "air conditioner buttons.";
+    const size_t text_iterations = iterations / 100;
+    reference_time = bench_run(text_iterations, [&](size_t i) {
+        text_layout_cache_clear();
+        elements_text_box(canvas, 2, 2, 120, 60, AlignLeft, AlignTop, article, true);
+    });
+    canvas_time = bench_run(text_iterations, [&](size_t i) {
+        elements_text_box(canvas, 2, 2, 120, 60, AlignLeft, AlignTop, article, true);
+    });
+    bench_report("text box", text_iterations, 120 * 60, reference_time, canvas_time);
+
+    // Animation redrawn every frame, decompressed each time and from the frame cache
+    const uint8_t icon_width = 64;
+    const uint8_t icon_height = 32;
+    const size_t icon_frames = 8;
+    std::vector<std::vector<uint8_t>> icon_data;
+    std::vector<const uint8_t*> icon_frame_data;
+    for(size_t f = 0; f < icon_frames; f++) {
+        std::vector<uint8_t> bitmap;
+        for(size_t y = 0; y < icon_height; y++) {
+            for(size_t x = 0; x < icon_width / 8; x++) {
+                bitmap.push_back((x + y / 4 + f) % 3 ? 0x00 : 0xF0 >> (y % 4));
+            }
+        }
+        icon_data.push_back(compress_icon(bitmap));
+    }
+    for(auto& data : icon_data) {
+        icon_frame_data.push_back(data.data());
+    }
+    const Icon animation_icon = {icon_width, icon_height, icon_frames, 8, icon_frame_data.data()};
+    IconAnimation* animation = icon_animation_alloc(&animation_icon);
+    const size_t icon_iterations = iterations / 10;
+    reference_time = bench_run(icon_iterations, [&](size_t i) {
+        icon_cache_clear();
+        icon_animation_next_frame(animation);
+        canvas_draw_icon_animation(canvas, 32, 16, animation);
+    });
+    canvas_time = bench_run(icon_iterations, [&](size_t i) {
+        icon_animation_next_frame(animation);
+        canvas_draw_icon_animation(canvas, 32, 16, animation);
+    });
+    icon_animation_free(animation);
+    IconCacheStats icon_stats;
+    icon_cache_get_stats(&icon_stats);
+    printf(
+        "icon cache: %zu frames, %zu bytes, %zu decodes, %zu hits, %zu evictions\n",
+        icon_stats.frames,
+        icon_stats.bytes_used,
+        icon_stats.decodes,
+        icon_stats.hits,
+        icon_stats.evictions);
+    bench_report(
+        "icon anim", icon_iterations, icon_width * icon_height, reference_time, canvas_time);
+
+    // Every buffer request follows a change, so the conversion is never cached
+    uint8_t pages[DISPLAY_WIDTH * DISPLAY_HEIGHT / 8];
+    reference_time = bench_run(iterations / 100, [&](size_t i) {
+        reference.set_pixel(i % DISPLAY_WIDTH, i % DISPLAY_HEIGHT);
+        reference_pages(reference, pages);
+        bench_sink = pages[i % sizeof(pages)];
+    });
+    canvas_time = bench_run(iterations / 100, [&](size_t i) {
+        canvas_draw_box(canvas, i % DISPLAY_WIDTH, i % DISPLAY_HEIGHT, 1, 1);
+        bench_sink = canvas_get_buffer(canvas)[i % sizeof(pages)];
+    });
+    bench_report(
+        "page buffer",
+        iterations / 100,
+        DISPLAY_WIDTH * DISPLAY_HEIGHT,
+        reference_time,
+        canvas_time);
+
+    const size_t expand_scale = 4;
+    const size_t expand_pixels = DISPLAY_WIDTH * DISPLAY_HEIGHT * expand_scale * expand_scale;
+    const size_t expand_iterations = iterations / 100;
+    const DisplayRegion full = {0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT};
+    const uint32_t palette[2] = {0xFFFF8200, 0xFF000000};
+    DisplayFrame frame;
+    for(size_t y = 0; y < DISPLAY_HEIGHT; y++) {
+        for(size_t i = 0; i < DISPLAY_ROW_WORDS; i++) {
+            frame.rows[y][i] = 0x9E3779B97F4A7C15ULL * (y * DISPLAY_ROW_WORDS + i + 1);
+        }
+    }
+    std::vector<uint8_t> rgb_image(expand_pixels * 3);
+    std::vector<uint32_t> image(expand_pixels);
+
+    reference_time = bench_run(expand_iterations, [&](size_t i) {
+        reference_expand(&frame, expand_scale, rgb_image.data());
+        bench_sink = rgb_image[i % rgb_image.size()];
+    });
+    canvas_time = bench_run(expand_iterations, [&](size_t i) {
+        display_expand(
+            &frame, full, palette, expand_scale, image.data(), DISPLAY_WIDTH * expand_scale);
+        bench_sink = image[i % image.size()];
+    });
+    printf("expand kernel: %s\n", display_expand_kernel_name());
+    bench_report("expand x4", expand_iterations, expand_pixels, reference_time, canvas_time);
+
+    // Same static frame every commit, drawn directly and through the display list
+    auto static_frame = [&]() {
+        canvas_reset(canvas);
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str(canvas, 2, 10, "Static frame");
+        canvas_draw_rframe(canvas, 0, 14, 128, 50, 4);
+        canvas_draw_box(canvas, 8, 24, 40, 30);
+        canvas_draw_disc(canvas, 90, 38, 14);
+        canvas_commit(canvas);
+    };
+    const size_t frame_iterations = iterations / 100;
+    reference_time = bench_run(frame_iterations, [&](size_t i) { static_frame(); });
+    canvas_set_display_list(canvas, true);
+    canvas_time = bench_run(frame_iterations, [&](size_t i) { static_frame(); });
+    CanvasDisplayListStats stats = canvas_get_display_list_stats(canvas);
+    canvas_set_display_list(canvas, false);
+    printf("display list: %u frames, %u skipped\n", stats.frames, stats.frames_skipped);
+    bench_report(
+        "static frame",
+        frame_iterations,
+        DISPLAY_WIDTH * DISPLAY_HEIGHT,
+        reference_time,
+        canvas_time);
+
+    // Rows a reset actually zeroes, for a frame painted over by a full screen box and for one
+    // drawing only a status line
+    auto clear_report = [&](const char* name, const std::function<void()>& draw) {
+        for(size_t i = 0; i < 2; i++) {
+            canvas_reset(canvas);
+            draw();
+            canvas_commit(canvas);
+        }
+        CanvasClearCounters counters = canvas_get_clear_stats(canvas).frame;
+        printf(
+            "clear %-6s %2u rows cleared, %2u covered, %2u clean\n",
+            name,
+            counters.rows_cleared,
+            counters.rows_covered,
+            counters.rows_clean);
+    };
+    clear_report("cover", [&]() {
+        canvas_draw_box(canvas, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        canvas_set_color(canvas, ColorWhite);
+        canvas_draw_str(canvas, 2, 10, "Inverted");
+    });
+    clear_report("status", [&]() { canvas_draw_str(canvas, 2, 10, "Status line"); });
+
+    // What the LCD controller receives for frames that only change a status line, with the
+    // whole buffer sent on every commit as u8g2 does and with only the changed pages
+    auto transfer_report = [&](const char* name, bool partial_pages) {
+        DisplayTransferConfig config;
+        display_transfer_get_config(&config);
+        DisplayTransferConfig report_config = config;
+        report_config.partial_pages = partial_pages;
+        display_transfer_set_config(&report_config);
+        DisplayTransferStats start;
+        display_transfer_get_stats(&start);
+        for(size_t i = 0; i < 100; i++) {
+            char status[16];
+            snprintf(status, sizeof(status), "Frame %zu", i);
+            canvas_reset(canvas);
+            canvas_draw_str(canvas, 2, 10, status);
+            canvas_commit(canvas);
+        }
+        DisplayTransferStats end;
+        display_transfer_get_stats(&end);
+        display_transfer_set_config(&config);
+        uint64_t frames = end.frames - start.frames;
+        uint64_t frame_ns = (end.transfer_ns - start.transfer_ns) / frames;
+        printf(
+            "transfer %-7s %4llu bytes and %4llu us per frame, bus allows %llu FPS\n",
+            name,
+            (unsigned long long)((end.bytes - start.bytes) / frames),
+            (unsigned long long)(frame_ns / 1000),
+            (unsigned long long)(frame_ns ? 1000000000 / frame_ns : 0));
+    };
+    transfer_report("full", false);
+    transfer_report("partial", true);
+
+    canvas_free(canvas);
+    return mismatch ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include <gui/canvas.h>
+#include <gui/canvas_i.h>
+#include <hal/display.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Canvas primitive timings against the headless display, for tracking regressions between
+// emulator versions. Every case is timed in repetitions of a calibrated number of calls, the
+// spread over repetitions gives the percentiles.
+//
+// usage: canvas_microbench [--repetitions N] [--warmup N] [--min-time MS] [--filter TEXT]
+//                          [--json FILE]
+
+struct BenchOptions {
+    size_t repetitions = 30;
+    size_t warmup = 3;
+    double min_time = 0.002; // seconds a repetition runs at least
+    const char* filter = nullptr;
+    const char* json = nullptr; // "-" for stdout
+};
+
+struct BenchCase {
+    std::string name;
+    std::function<void(size_t)> setup; // draw state, runs before timing
+    std::function<void(size_t)> body; // one call, argument is the call index
+    size_t pixels = 0; // pixels one call writes, counted on a clear canvas when 0
+};
+
+struct BenchResult {
+    std::string name;
+    size_t iterations; // calls per repetition
+    size_t pixels; // pixels one call writes
+    double min;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+};
+
+// Nearest rank percentile of sorted samples
+static double percentile(const std::vector<double>& samples, double rank) {
+    size_t index = (size_t)(rank / 100 * samples.size() + 0.999999);
+    return samples[std::clamp<size_t>(index, 1, samples.size()) - 1];
+}
+
+static double time_calls(const BenchCase& bench, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; i++) {
+        bench.body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+static size_t count_pixels(Canvas* canvas) {
+    const uint8_t* pages = canvas_get_buffer(canvas);
+    size_t pixels = 0;
+    for(size_t i = 0; i < canvas_get_buffer_size(canvas); i++) {
+        pixels += std::popcount(pages[i]);
+    }
+    return pixels;
+}
+
+static BenchResult run_case(Canvas* canvas, const BenchCase& bench, const BenchOptions& options) {
+    BenchResult result = {};
+    result.name = bench.name;
+
+    canvas_reset(canvas);
+    bench.setup(0);
+    bench.body(0);
+    result.pixels = bench.pixels ? bench.pixels : count_pixels(canvas);
+    canvas_reset(canvas);
+    bench.setup(0);
+
+    // Double the calls until a repetition is long enough for the clock
+    size_t iterations = 1;
+    while(time_calls(bench, iterations) < options.min_time && iterations < (1 << 30)) {
+        iterations *= 2;
+    }
+    result.iterations = iterations;
+
+    for(size_t i = 0; i < options.warmup; i++) {
+        time_calls(bench, iterations);
+    }
+
+    std::vector<double> samples;
+    for(size_t i = 0; i < options.repetitions; i++) {
+        samples.push_back(time_calls(bench, iterations) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    result.min = samples.front();
+    for(double sample : samples) {
+        result.mean += sample / samples.size();
+    }
+    result.p50 = percentile(samples, 50);
+    result.p90 = percentile(samples, 90);
+    result.p99 = percentile(samples, 99);
+    return result;
+}
+
+static std::vector<BenchCase> make_cases(Canvas* canvas) {
+    std::vector<BenchCase> cases;
+    auto black = [canvas](size_t) { canvas_set_color(canvas, ColorBlack); };
+
+    const struct {
+        const char* name;
+        Font font;
+        const char* text;
+    } fonts[] = {
+        {"str primary", FontPrimary, "Hello, Flipper!"},
+        {"str secondary", FontSecondary, "Hello, Flipper!"},
+        {"str keyboard", FontKeyboard, "Hello, Flipper!"},
+        {"str big numbers", FontBigNumbers, "0123456789"},
+    };
+    for(const auto& font : fonts) {
+        cases.push_back({
+            font.name,
+            [canvas, font](size_t) { canvas_set_font(canvas, font.font); },
+            [canvas, font](size_t i) { canvas_draw_str(canvas, i % 4, 30, font.text); },
+        });
+    }
+
+    cases.push_back({
+        "box",
+        black,
+        [canvas](size_t i) { canvas_draw_box(canvas, i % 16, i % 16, 100, 40); },
+    });
+    cases.push_back({
+        "frame",
+        black,
+        [canvas](size_t i) { canvas_draw_frame(canvas, i % 16, i % 16, 100, 40); },
+    });
+    cases.push_back({
+        "rframe",
+        black,
+        [canvas](size_t i) { canvas_draw_rframe(canvas, i % 16, i % 16, 100, 40, 5); },
+    });
+    cases.push_back({
+        "circle",
+        black,
+        [canvas](size_t i) { canvas_draw_circle(canvas, 32 + i % 64, 32, 20); },
+    });
+    cases.push_back({
+        "disc",
+        black,
+        [canvas](size_t i) { canvas_draw_disc(canvas, 32 + i % 64, 32, 20); },
+    });
+    // Clears are lazy, the line dirties every row so each clear has all of them to zero
+    cases.push_back({
+        "clear",
+        black,
+        [canvas](size_t i) {
+            canvas_clear(canvas);
+            canvas_draw_line(canvas, i % DISPLAY_WIDTH, 0, i % DISPLAY_WIDTH, DISPLAY_HEIGHT - 1);
+        },
+        DISPLAY_WIDTH * DISPLAY_HEIGHT,
+    });
+    // Frame with text and shapes, changed by one box every commit
+    cases.push_back({
+        "commit",
+        [canvas](size_t) {
+            canvas_set_font(canvas, FontSecondary);
+            canvas_draw_str(canvas, 2, 10, "Commit frame");
+            canvas_draw_rframe(canvas, 0, 14, DISPLAY_WIDTH, 50, 4);
+            canvas_draw_disc(canvas, 90, 38, 14);
+        },
+        [canvas](size_t i) {
+            canvas_set_color(canvas, i & 1 ? ColorWhite : ColorBlack);
+            canvas_draw_box(canvas, 8, 24, 40, 30);
+            canvas_commit(canvas);
+        },
+        DISPLAY_WIDTH * DISPLAY_HEIGHT,
+    });
+    return cases;
+}
+
+static void
+    write_json(FILE* file, const BenchOptions& options, const std::vector<BenchResult>& results) {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"benchmark\": \"canvas_microbench\",\n");
+    fprintf(file, "  \"repetitions\": %zu,\n", options.repetitions);
+    fprintf(file, "  \"warmup\": %zu,\n", options.warmup);
+    fprintf(file, "  \"results\": [\n");
+    for(size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"name\": \"%s\",\n", result.name.c_str());
+        fprintf(file, "      \"iterations\": %zu,\n", result.iterations);
+        fprintf(file, "      \"pixels_per_op\": %zu,\n", result.pixels);
+        fprintf(
+            file,
+            "      \"ns_per_op\": {\"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, "
+            "\"p90\": %.3f, \"p99\": %.3f},\n",
+            result.min,
+            result.mean,
+            result.p50,
+            result.p90,
+            result.p99);
+        fprintf(file, "      \"pixels_per_second\": %.0f\n", result.pixels * 1e9 / result.p50);
+        fprintf(file, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+}
+
+static void usage(const char* name) {
+    fprintf(
+        stderr,
+        "usage: %s [--repetitions N] [--warmup N] [--min-time MS] [--filter TEXT] "
+        "[--json FILE]\n",
+        name);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for(int i = 1; i < argc; i++) {
+        if(i + 1 == argc) usage(argv[0]);
+        const char* value = argv[++i];
+        if(!strcmp(argv[i - 1], "--repetitions")) {
+            options.repetitions = std::max(atoi(value), 1);
+        } else if(!strcmp(argv[i - 1], "--warmup")) {
+            options.warmup = std::max(atoi(value), 0);
+        } else if(!strcmp(argv[i - 1], "--min-time")) {
+            options.min_time = atof(value) / 1000;
+        } else if(!strcmp(argv[i - 1], "--filter")) {
+            options.filter = value;
+        } else if(!strcmp(argv[i - 1], "--json")) {
+            options.json = value;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    Canvas* canvas = canvas_init();
+    canvas_frame_set(canvas, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+
+    // Table goes to stderr when JSON takes stdout
+    bool json_stdout = options.json && !strcmp(options.json, "-");
+    FILE* table = json_stdout ? stderr : stdout;
+    fprintf(
+        table,
+        "%-16s %10s %10s %10s %10s %8s %12s\n",
+        "case",
+        "min ns",
+        "p50 ns",
+        "p90 ns",
+        "p99 ns",
+        "px/op",
+        "Mpx/s");
+
+    std::vector<BenchResult> results;
+    for(const BenchCase& bench : make_cases(canvas)) {
+        if(options.filter && bench.name.find(options.filter) == std::string::npos) continue;
+        BenchResult result = run_case(canvas, bench, options);
+        fprintf(
+            table,
+            "%-16s %10.1f %10.1f %10.1f %10.1f %8zu %12.1f\n",
+            result.name.c_str(),
+            result.min,
+            result.p50,
+            result.p90,
+            result.p99,
+            result.pixels,
+            result.pixels * 1e3 / result.p50);
+        results.push_back(result);
+    }
+
+    if(options.json) {
+        FILE* file = json_stdout ? stdout : fopen(options.json, "w");
+        if(!file) {
+            perror(options.json);
+            return 1;
+        }
+        write_json(file, options, results);
+        if(file != stdout) fclose(file);
+    }
+
+    canvas_free(canvas);
+    return 0;
+}
\ No newline at end of file
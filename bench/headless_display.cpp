@@ -0,0 +1,23 @@
+#include <hal/display.h>
+#include <hal/display_transfer.h>
+
+// Display HAL without Qt, lets canvas code run in benchmarks
+static DisplayFrame display_frame;
+static uint64_t display_frames_produced = 0;
+
+DisplayFrame* get_display_buffer() {
+    return &display_frame;
+}
+
+void commit_display_buffer(bool redraw, DisplayRegion region) {
+    // Always modeled, the bench reports the transfer of its commits
+    display_transfer_commit(region);
+    if(redraw) display_frames_produced++;
+}
+
+void get_display_frame_stats(DisplayFrameStats* stats) {
+    // Nothing presents frames
+    stats->produced = display_frames_produced;
+    stats->presented = 0;
+    stats->dropped = 0;
+}
\ No newline at end of file
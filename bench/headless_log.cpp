@@ -0,0 +1,15 @@
+#include <furi.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+// Log HAL without Qt, the bench prints its own report so only warnings and errors get through
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
+    if(level != FuriLogLevelError && level != FuriLogLevelWarn) return;
+
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%s][%s] ", level == FuriLogLevelError ? "E" : "W", tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
\ No newline at end of file
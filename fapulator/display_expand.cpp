@@ -0,0 +1,178 @@
+#include "hal/display_expand.h"
+#include <algorithm>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DISPLAY_EXPAND_SSE2
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DISPLAY_EXPAND_AVX2
+#endif
+
+typedef void (*ExpandRow)(
+    const uint64_t* row,
+    size_t x_start,
+    size_t x_end,
+    const uint32_t* palette,
+    size_t scale,
+    uint32_t* out);
+
+static inline uint32_t row_bits(const uint64_t* row, size_t x, size_t count) {
+    // Groups never cross a word since they start at a multiple of their size
+    return (row[x / 64] >> (x % 64)) & ((1U << count) - 1);
+}
+
+static void expand_row_scalar(
+    const uint64_t* row,
+    size_t x_start,
+    size_t x_end,
+    const uint32_t* palette,
+    size_t scale,
+    uint32_t* out) {
+    for(size_t x = x_start; x < x_end; x++) {
+        uint32_t pixel = palette[row_bits(row, x, 1)];
+        for(size_t i = 0; i < scale; i++) {
+            *out++ = pixel;
+        }
+    }
+}
+
+#ifdef DISPLAY_EXPAND_SSE2
+// 4 pixels per nibble, scales other than 1, 2 and 4 would need a byte shuffle
+static void expand_row_sse2(
+    const uint64_t* row,
+    size_t x_start,
+    size_t x_end,
+    const uint32_t* palette,
+    size_t scale,
+    uint32_t* out) {
+    if(scale != 1 && scale != 2 && scale != 4) {
+        expand_row_scalar(row, x_start, x_end, palette, scale, out);
+        return;
+    }
+
+    size_t x = std::min(x_end, (x_start + 3) & ~(size_t)3);
+    expand_row_scalar(row, x_start, x, palette, scale, out);
+    out += (x - x_start) * scale;
+
+    const __m128i reset = _mm_set1_epi32(palette[0]);
+    const __m128i toggle = _mm_set1_epi32(palette[0] ^ palette[1]);
+    const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+    for(; x + 4 <= x_end; x += 4) {
+        __m128i bits = _mm_and_si128(_mm_set1_epi32(row_bits(row, x, 4)), lanes);
+        __m128i pixels = _mm_xor_si128(reset, _mm_and_si128(_mm_cmpeq_epi32(bits, lanes), toggle));
+        __m128i* target = (__m128i*)out;
+        if(scale == 1) {
+            _mm_storeu_si128(target, pixels);
+        } else if(scale == 2) {
+            _mm_storeu_si128(target, _mm_unpacklo_epi32(pixels, pixels));
+            _mm_storeu_si128(target + 1, _mm_unpackhi_epi32(pixels, pixels));
+        } else {
+            _mm_storeu_si128(target, _mm_shuffle_epi32(pixels, 0x00));
+            _mm_storeu_si128(target + 1, _mm_shuffle_epi32(pixels, 0x55));
+            _mm_storeu_si128(target + 2, _mm_shuffle_epi32(pixels, 0xAA));
+            _mm_storeu_si128(target + 3, _mm_shuffle_epi32(pixels, 0xFF));
+        }
+        out += 4 * scale;
+    }
+
+    expand_row_scalar(row, x, x_end, palette, scale, out);
+}
+#endif
+
+#ifdef DISPLAY_EXPAND_AVX2
+static constexpr size_t AVX2_MAX_SCALE = 8;
+
+// 8 pixels per byte, each output vector picks its pixels with a lane permutation
+__attribute__((target("avx2"))) static void expand_row_avx2(
+    const uint64_t* row,
+    size_t x_start,
+    size_t x_end,
+    const uint32_t* palette,
+    size_t scale,
+    uint32_t* out) {
+    if(scale > AVX2_MAX_SCALE) {
+        expand_row_scalar(row, x_start, x_end, palette, scale, out);
+        return;
+    }
+
+    size_t x = std::min(x_end, (x_start + 7) & ~(size_t)7);
+    expand_row_scalar(row, x_start, x, palette, scale, out);
+    out += (x - x_start) * scale;
+
+    // Lane j of output vector k holds pixel (k * 8 + j) / scale
+    __m256i permute[AVX2_MAX_SCALE];
+    for(size_t k = 0; k < scale; k++) {
+        alignas(32) int32_t index[8];
+        for(size_t j = 0; j < 8; j++) {
+            index[j] = (k * 8 + j) / scale;
+        }
+        permute[k] = _mm256_load_si256((const __m256i*)index);
+    }
+
+    const __m256i reset = _mm256_set1_epi32(palette[0]);
+    const __m256i toggle = _mm256_set1_epi32(palette[0] ^ palette[1]);
+    const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    for(; x + 8 <= x_end; x += 8) {
+        __m256i bits = _mm256_and_si256(_mm256_set1_epi32(row_bits(row, x, 8)), lanes);
+        __m256i pixels =
+            _mm256_xor_si256(reset, _mm256_and_si256(_mm256_cmpeq_epi32(bits, lanes), toggle));
+        for(size_t k = 0; k < scale; k++) {
+            _mm256_storeu_si256(
+                (__m256i*)out + k, _mm256_permutevar8x32_epi32(pixels, permute[k]));
+        }
+        out += 8 * scale;
+    }
+
+    expand_row_scalar(row, x, x_end, palette, scale, out);
+}
+#endif
+
+struct ExpandKernel {
+    const char* name;
+    ExpandRow expand_row;
+};
+
+static ExpandKernel select_kernel() {
+#ifdef DISPLAY_EXPAND_AVX2
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return {"avx2", expand_row_avx2};
+    }
+#endif
+#ifdef DISPLAY_EXPAND_SSE2
+    return {"sse2", expand_row_sse2};
+#else
+    return {"scalar", expand_row_scalar};
+#endif
+}
+
+static const ExpandKernel kernel = select_kernel();
+
+void display_expand(
+    const DisplayFrame* frame,
+    const DisplayRegion& region,
+    const uint32_t palette[2],
+    size_t scale,
+    uint32_t* image,
+    size_t image_stride) {
+    size_t x_end = region.x + region.width;
+    size_t line_bytes = region.width * scale * sizeof(uint32_t);
+
+    for(size_t y = region.y; y < region.y + region.height; y++) {
+        uint32_t* line = image + y * scale * image_stride + region.x * scale;
+        kernel.expand_row(frame->rows[y], region.x, x_end, palette, scale, line);
+
+        // Rest of the block rows are the same
+        for(size_t i = 1; i < scale; i++) {
+            memcpy(line + i * image_stride, line, line_bytes);
+        }
+    }
+}
+
+const char* display_expand_kernel_name() {
+    return kernel.name;
+}
\ No newline at end of file
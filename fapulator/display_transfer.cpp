@@ -0,0 +1,123 @@
+#include "hal/display_transfer.h"
+#include <furi.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#define TAG "DisplayTransfer"
+
+// u8g2 sends each page as page address, column address high and low, then the column bytes
+static constexpr DisplayTransferConfig display_transfer_default_config = {
+    .bus_hz = DISPLAY_TRANSFER_BUS_HZ,
+    .page_command_bytes = 3,
+    .page_overhead_ns = 5000,
+    .partial_pages = DISPLAY_TRANSFER_PARTIAL_PAGES,
+    .throttle = DISPLAY_TRANSFER_THROTTLE,
+};
+
+class DisplayTransfer {
+private:
+    static constexpr auto LOG_INTERVAL = std::chrono::seconds(1);
+
+    std::mutex mutex;
+    DisplayTransferConfig config = display_transfer_default_config;
+    DisplayTransferStats stats = {};
+    // Since the last log line
+    uint64_t log_frames = 0;
+    uint64_t log_bytes = 0;
+    uint64_t log_ns = 0;
+    std::chrono::steady_clock::time_point log_time = std::chrono::steady_clock::now();
+
+    void log() {
+        uint64_t frame_ns = log_ns / log_frames;
+        FURI_LOG_I(
+            TAG,
+            "%llu frames, %llu bytes and %llu us per frame, bus allows %llu FPS",
+            (unsigned long long)log_frames,
+            (unsigned long long)(log_bytes / log_frames),
+            (unsigned long long)(frame_ns / 1000),
+            (unsigned long long)(frame_ns ? 1000000000 / frame_ns : 0));
+        log_frames = 0;
+        log_bytes = 0;
+        log_ns = 0;
+    }
+
+public:
+    void get_config(DisplayTransferConfig* config) {
+        std::lock_guard<std::mutex> lock(mutex);
+        *config = this->config;
+    }
+
+    void set_config(const DisplayTransferConfig* config) {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->config = *config;
+    }
+
+    uint64_t commit(const DisplayRegion& region) {
+        std::unique_lock<std::mutex> lock(mutex);
+        size_t pages = DISPLAY_PAGES;
+        size_t columns = DISPLAY_WIDTH;
+        if(config.partial_pages) {
+            if(region.width == 0 || region.height == 0) {
+                pages = 0;
+            } else {
+                size_t first_page = region.y / DISPLAY_PAGE_HEIGHT;
+                size_t last_page = (region.y + region.height - 1) / DISPLAY_PAGE_HEIGHT;
+                pages = last_page - first_page + 1;
+                columns = region.width;
+            }
+        }
+
+        uint64_t bytes = pages * (config.page_command_bytes + columns);
+        uint64_t transfer_ns = pages * config.page_overhead_ns;
+        if(config.bus_hz) {
+            transfer_ns += bytes * 8 * 1000000000 / config.bus_hz;
+        }
+
+        stats.frames++;
+        stats.pages += pages;
+        stats.bytes += bytes;
+        stats.transfer_ns += transfer_ns;
+        stats.transfer_ns_max = std::max(stats.transfer_ns_max, transfer_ns);
+        log_frames++;
+        log_bytes += bytes;
+        log_ns += transfer_ns;
+
+        auto now = std::chrono::steady_clock::now();
+        if(now - log_time >= LOG_INTERVAL) {
+            log_time = now;
+            log();
+        }
+
+        if(config.throttle) {
+            stats.throttle_ns += transfer_ns;
+            lock.unlock();
+            std::this_thread::sleep_until(now + std::chrono::nanoseconds(transfer_ns));
+        }
+        return transfer_ns;
+    }
+
+    void get_stats(DisplayTransferStats* stats) {
+        std::lock_guard<std::mutex> lock(mutex);
+        *stats = this->stats;
+    }
+};
+
+static DisplayTransfer display_transfer;
+
+void display_transfer_get_config(DisplayTransferConfig* config) {
+    display_transfer.get_config(config);
+}
+
+void display_transfer_set_config(const DisplayTransferConfig* config) {
+    display_transfer.set_config(config);
+}
+
+uint64_t display_transfer_commit(const DisplayRegion& region) {
+    return display_transfer.commit(region);
+}
+
+void display_transfer_get_stats(DisplayTransferStats* stats) {
+    display_transfer.get_stats(stats);
+}
\ No newline at end of file
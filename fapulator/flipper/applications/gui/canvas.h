@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <gui/icon_animation.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,7 @@ extern "C" {
 typedef enum {
     ColorWhite = 0x00,
     ColorBlack = 0x01,
+    ColorXOR = 0x02,
 } Color;
 
 /** Fonts enumeration */
@@ -196,6 +198,28 @@ void canvas_draw_bitmap(
     uint8_t height,
     const uint8_t* compressed_bitmap_data);
 
+/** Draw animation at position defined by x,y.
+ *
+ * @param      canvas          Canvas instance
+ * @param      x               x coordinate
+ * @param      y               y coordinate
+ * @param      icon_animation  IconAnimation instance
+ */
+void canvas_draw_icon_animation(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    IconAnimation* icon_animation);
+
+/** Draw icon at position defined by x,y.
+ *
+ * @param      canvas  Canvas instance
+ * @param      x       x coordinate
+ * @param      y       y coordinate
+ * @param      icon    Icon instance
+ */
+void canvas_draw_icon(Canvas* canvas, uint8_t x, uint8_t y, const Icon* icon);
+
 /** Draw XBM bitmap
  *
  * @param      canvas  Canvas instance
@@ -286,6 +310,23 @@ void canvas_draw_triangle(
     uint8_t height,
     CanvasDirection dir);
 
+/** Draw filled triangle, same shape as canvas_draw_triangle
+ *
+ * @param       canvas  Canvas instance
+ * @param       x       x coordinate of base and height intersection
+ * @param       y       y coordinate of base and height intersection
+ * @param       base    length of triangle side
+ * @param       height  length of triangle height
+ * @param       dir     CanvasDirection triangle orientation
+ */
+void canvas_draw_triangle_filled(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t base,
+    uint8_t height,
+    CanvasDirection dir);
+
 /** Draw glyph
  *
  * @param      canvas  Canvas instance
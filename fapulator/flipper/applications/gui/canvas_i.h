@@ -24,6 +24,41 @@ struct Canvas {
     uint8_t height;
 };
 
+/** Display list counters
+ */
+typedef struct {
+    uint32_t frames; /**< committed frames */
+    uint32_t frames_skipped; /**< frames equal to the previous one, not drawn or sent */
+} CanvasDisplayListStats;
+
+/** Canvas clear counters, in display rows. Every cleared row is counted once as cleared,
+ * covered or clean.
+ */
+typedef struct {
+    uint32_t clears; /**< canvas_clear and canvas_reset calls */
+    uint32_t rows_cleared; /**< rows zeroed */
+    uint32_t rows_covered; /**< rows not zeroed as an opaque full width box overwrote them */
+    uint32_t rows_clean; /**< rows not zeroed as nothing was drawn on them since the last clear */
+} CanvasClearCounters;
+
+/** Canvas clear counters of the last committed frame and since canvas_init
+ */
+typedef struct {
+    CanvasClearCounters frame;
+    CanvasClearCounters total;
+} CanvasClearStats;
+
+/** Operation counts since canvas_init, input of the device cost model in canvas_cost.h.
+ * Only counted when built with CANVAS_COST_MODEL.
+ */
+typedef struct {
+    uint32_t primitives; /**< draw calls, strings and bitmaps included */
+    uint32_t pixels; /**< pixels written */
+    uint32_t glyphs; /**< glyphs drawn, the device decodes every one from the font */
+    uint32_t glyph_bits; /**< font bitstream bits read for them */
+    uint32_t clears; /**< canvas_clear and canvas_reset calls */
+} CanvasCostCounters;
+
 /** Allocate memory and initialize canvas
  *
  * @return     Canvas instance
@@ -94,6 +129,49 @@ void canvas_set_orientation(Canvas* canvas, CanvasOrientation orientation);
  */
 CanvasOrientation canvas_get_orientation(const Canvas* canvas);
 
+/** Get current font
+ *
+ * @param      canvas  Canvas instance
+ *
+ * @return     u8g2 font data
+ */
+const uint8_t* canvas_get_font(const Canvas* canvas);
+
+/** Record drawing into a display list, rasterized on commit
+ * Frames starting with a clear that are identical to the previous frame are skipped.
+ * Disabling draws pending commands.
+ *
+ * @param      canvas  Canvas instance
+ * @param      enable  true to record
+ */
+void canvas_set_display_list(Canvas* canvas, bool enable);
+
+/** Get display list counters
+ *
+ * @param      canvas  Canvas instance
+ *
+ * @return     CanvasDisplayListStats
+ */
+CanvasDisplayListStats canvas_get_display_list_stats(const Canvas* canvas);
+
+/** Get clear counters
+ * A clear only zeroes the rows drawn on since the previous one, and rows a full width box
+ * paints over before anything else touches them are not zeroed at all.
+ *
+ * @param      canvas  Canvas instance
+ *
+ * @return     CanvasClearStats
+ */
+CanvasClearStats canvas_get_clear_stats(const Canvas* canvas);
+
+/** Get operation counts
+ *
+ * @param      canvas  Canvas instance
+ *
+ * @return     CanvasCostCounters
+ */
+CanvasCostCounters canvas_get_cost_counters(const Canvas* canvas);
+
 #ifdef __cplusplus
 }
 #endif
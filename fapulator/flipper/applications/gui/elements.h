@@ -0,0 +1,191 @@
+/**
+ * @file elements.h
+ * GUI: Elements API
+ *
+ * Canvas helpers to draw UI elements
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "canvas.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Draw progress bar.
+ *
+ * @param      canvas    Canvas instance
+ * @param      x         progress bar position on X axis
+ * @param      y         progress bar position on Y axis
+ * @param      width     progress bar width
+ * @param      progress  progress (0.0 - 1.0)
+ */
+void elements_progress_bar(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, float progress);
+
+/** Draw scrollbar on canvas at specific position.
+ *
+ * @param      canvas  Canvas instance
+ * @param      x       scrollbar position on X axis
+ * @param      y       scrollbar position on Y axis
+ * @param      height  scrollbar height
+ * @param      pos     current element
+ * @param      total   total elements
+ */
+void elements_scrollbar_pos(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t height,
+    uint16_t pos,
+    uint16_t total);
+
+/** Draw scrollbar on canvas.
+ * @note       width 3px, height equal to canvas height
+ *
+ * @param      canvas  Canvas instance
+ * @param      pos     current element of total elements
+ * @param      total   total elements
+ */
+void elements_scrollbar(Canvas* canvas, uint16_t pos, uint16_t total);
+
+/** Draw rounded frame
+ *
+ * @param      canvas          Canvas instance
+ * @param      x, y            top left corner coordinates
+ * @param      width, height   frame width and height
+ */
+void elements_frame(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+
+/** Draw button in left corner
+ *
+ * @param      canvas  Canvas instance
+ * @param      str     button text
+ */
+void elements_button_left(Canvas* canvas, const char* str);
+
+/** Draw button in right corner
+ *
+ * @param      canvas  Canvas instance
+ * @param      str     button text
+ */
+void elements_button_right(Canvas* canvas, const char* str);
+
+/** Draw button in center
+ *
+ * @param      canvas  Canvas instance
+ * @param      str     button text
+ */
+void elements_button_center(Canvas* canvas, const char* str);
+
+/** Draw aligned multiline text
+ * Lines that do not fit the canvas are broken with a dash, the last visible one ends with
+ * "..." instead.
+ *
+ * @param      canvas      Canvas instance
+ * @param      x, y        coordinates based on align param
+ * @param      horizontal  horizontal alignment
+ * @param      vertical    vertical alignment
+ * @param      text        string (possible multiline)
+ */
+void elements_multiline_text_aligned(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    const char* text);
+
+/** Draw multiline text
+ *
+ * @param      canvas  Canvas instance
+ * @param      x, y    top left corner coordinates
+ * @param      text    string (possible multiline)
+ */
+void elements_multiline_text(Canvas* canvas, uint8_t x, uint8_t y, const char* text);
+
+/** Draw framed multiline text
+ *
+ * @param      canvas  Canvas instance
+ * @param      x, y    top left corner coordinates
+ * @param      text    string (possible multiline)
+ */
+void elements_multiline_text_framed(Canvas* canvas, uint8_t x, uint8_t y, const char* text);
+
+/** Draw slightly rounded frame
+ *
+ * @param      canvas          Canvas instance
+ * @param      x, y            top left corner coordinates
+ * @param      width, height   size of frame
+ */
+void elements_slightly_rounded_frame(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height);
+
+/** Draw slightly rounded box
+ *
+ * @param      canvas          Canvas instance
+ * @param      x, y            top left corner coordinates
+ * @param      width, height   size of box
+ */
+void elements_slightly_rounded_box(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height);
+
+/** Draw bold rounded frame
+ *
+ * @param      canvas          Canvas instance
+ * @param      x, y            top left corner coordinates
+ * @param      width, height   size of frame
+ */
+void elements_bold_rounded_frame(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height);
+
+/** Draw bubble frame for text
+ *
+ * @param      canvas  Canvas instance
+ * @param      x       left x coordinates
+ * @param      y       top y coordinate
+ * @param      width   bubble width
+ * @param      height  bubble height
+ */
+void elements_bubble(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+
+/** Draw word wrapped text box
+ * Text is broken on spaces and new lines, words longer than a line are broken anywhere.
+ * Font markup of the firmware text box is not supported.
+ *
+ * @param      canvas          Canvas instance
+ * @param      x, y            top left corner coordinates
+ * @param      width, height   size of text box
+ * @param      horizontal      horizontal alignment
+ * @param      vertical        vertical alignment
+ * @param      text            formatted text
+ * @param      strip_to_dots   end the last line with "..." if the text does not fit
+ */
+void elements_text_box(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    Align horizontal,
+    Align vertical,
+    const char* text,
+    bool strip_to_dots);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
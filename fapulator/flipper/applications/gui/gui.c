@@ -203,6 +203,102 @@ bool gui_redraw_window(Gui* gui) {
     return false;
 }
 
+static void gui_framebuffer_lock(Gui* gui) {
+    furi_check(furi_mutex_acquire(gui->framebuffer_mutex, FuriWaitForever) == FuriStatusOk);
+}
+
+static void gui_framebuffer_unlock(Gui* gui) {
+    furi_check(furi_mutex_release(gui->framebuffer_mutex) == FuriStatusOk);
+}
+
+// Queue committed frame for framebuffer callbacks, never waits for them
+static void gui_framebuffer_push(Gui* gui) {
+    gui_framebuffer_lock(gui);
+    bool has_callbacks = CanvasCallbackPairArray_size(gui->canvas_callback_pair) > 0;
+    if(has_callbacks) {
+        uint8_t* frame = gui->frames[gui->frames_committed % GUI_FRAMEBUFFER_RING_SIZE];
+        memcpy(frame, canvas_get_buffer(gui->canvas), GUI_FRAMEBUFFER_SIZE);
+        gui->frames_committed++;
+    }
+    gui_framebuffer_unlock(gui);
+
+    if(has_callbacks) {
+        furi_thread_flags_set(furi_thread_get_id(gui->dispatch_thread), GUI_DISPATCH_FLAG_FRAME);
+    }
+}
+
+// Copy next frame for callback into `frame`, false if there is none pending
+static bool gui_framebuffer_take(Gui* gui, CanvasCallbackPair* p, uint8_t* frame) {
+    uint32_t pending = gui->frames_committed - p->next_frame;
+    if(!pending) {
+        return false;
+    }
+
+    if(p->policy == GuiFramebufferPolicyLatest) {
+        p->lag += pending - 1;
+        p->next_frame = gui->frames_committed - 1;
+    } else if(pending > GUI_FRAMEBUFFER_RING_SIZE) {
+        // Oldest frames were overwritten by newer commits
+        p->lag += pending - GUI_FRAMEBUFFER_RING_SIZE;
+        p->next_frame = gui->frames_committed - GUI_FRAMEBUFFER_RING_SIZE;
+    }
+
+    memcpy(frame, gui->frames[p->next_frame % GUI_FRAMEBUFFER_RING_SIZE], GUI_FRAMEBUFFER_SIZE);
+    p->next_frame++;
+    return true;
+}
+
+static int32_t gui_framebuffer_dispatch(void* context) {
+    Gui* gui = context;
+    uint8_t frame[GUI_FRAMEBUFFER_SIZE];
+
+    while(1) {
+        furi_thread_flags_wait(GUI_DISPATCH_FLAG_FRAME, FuriFlagWaitAny, FuriWaitForever);
+
+        // One frame per call, callbacks take turns so a lossless one catching up does not
+        // starve the others
+        bool dispatched = true;
+        while(dispatched) {
+            dispatched = false;
+            furi_check(furi_mutex_acquire(gui->dispatch_mutex, FuriWaitForever) == FuriStatusOk);
+
+            gui_framebuffer_lock(gui);
+            CanvasCallbackPair pair = {0};
+            size_t count = CanvasCallbackPairArray_size(gui->canvas_callback_pair);
+            for(size_t i = 0; i < count && !dispatched; i++) {
+                gui->dispatch_index = (gui->dispatch_index + 1) % count;
+                CanvasCallbackPair* p =
+                    CanvasCallbackPairArray_get(gui->canvas_callback_pair, gui->dispatch_index);
+                if(gui_framebuffer_take(gui, p, frame)) {
+                    pair = *p;
+                    dispatched = true;
+                }
+            }
+            gui_framebuffer_unlock(gui);
+
+            if(dispatched) {
+                pair.callback(frame, GUI_FRAMEBUFFER_SIZE, pair.context);
+            }
+            furi_check(furi_mutex_release(gui->dispatch_mutex) == FuriStatusOk);
+        }
+    }
+
+    return 0;
+}
+
+// Index of callback, or the callback count if it is not registered
+static size_t
+    gui_framebuffer_callback_find(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
+    size_t count = CanvasCallbackPairArray_size(gui->canvas_callback_pair);
+    for(size_t i = 0; i < count; i++) {
+        CanvasCallbackPair* p = CanvasCallbackPairArray_get(gui->canvas_callback_pair, i);
+        if(p->callback == callback && p->context == context) {
+            return i;
+        }
+    }
+    return count;
+}
+
 bool gui_redraw_desktop(Gui* gui) {
     canvas_set_orientation(gui->canvas, CanvasOrientationHorizontal);
     canvas_frame_set(gui->canvas, 0, 0, GUI_DISPLAY_WIDTH, GUI_DISPLAY_HEIGHT);
@@ -237,11 +333,7 @@ void gui_redraw(Gui* gui) {
     }
 
     canvas_commit(gui->canvas);
-    // for
-    //     M_EACH(p, gui->canvas_callback_pair, CanvasCallbackPairArray_t) {
-    //         p->callback(
-    //             canvas_get_buffer(gui->canvas), canvas_get_buffer_size(gui->canvas), p->context);
-    //     }
+    gui_framebuffer_push(gui);
     gui_unlock(gui);
 }
 
@@ -431,14 +523,24 @@ void gui_view_port_send_to_back(Gui* gui, ViewPort* view_port) {
 }
 
 void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
-    furi_assert(gui);
+    gui_add_framebuffer_callback_ex(gui, callback, context, GuiFramebufferPolicyLossless);
+}
 
-    const CanvasCallbackPair p = {callback, context};
+void gui_add_framebuffer_callback_ex(
+    Gui* gui,
+    GuiCanvasCommitCallback callback,
+    void* context,
+    GuiFramebufferPolicy policy) {
+    furi_assert(gui);
 
-    gui_lock(gui);
-    furi_assert(!CanvasCallbackPairArray_count(gui->canvas_callback_pair, p));
+    gui_framebuffer_lock(gui);
+    furi_assert(
+        gui_framebuffer_callback_find(gui, callback, context) ==
+        CanvasCallbackPairArray_size(gui->canvas_callback_pair));
+    // Delivery starts with the next commit
+    const CanvasCallbackPair p = {callback, context, policy, gui->frames_committed, 0};
     CanvasCallbackPairArray_push_back(gui->canvas_callback_pair, p);
-    gui_unlock(gui);
+    gui_framebuffer_unlock(gui);
 
     // Request redraw
     gui_update(gui);
@@ -447,18 +549,39 @@ void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, vo
 void gui_remove_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
     furi_assert(gui);
 
-    const CanvasCallbackPair p = {callback, context};
+    gui_framebuffer_lock(gui);
+    size_t index = gui_framebuffer_callback_find(gui, callback, context);
+    furi_assert(index < CanvasCallbackPairArray_size(gui->canvas_callback_pair));
+    CanvasCallbackPairArray_erase(gui->canvas_callback_pair, index);
+    gui_framebuffer_unlock(gui);
+
+    // Wait for a call in progress, context may be freed once we return. A callback removing
+    // itself is the call in progress, it holds dispatch_mutex already.
+    if(furi_thread_get_current_id() != furi_thread_get_id(gui->dispatch_thread)) {
+        furi_check(furi_mutex_acquire(gui->dispatch_mutex, FuriWaitForever) == FuriStatusOk);
+        furi_check(furi_mutex_release(gui->dispatch_mutex) == FuriStatusOk);
+    }
+}
 
-    gui_lock(gui);
-    furi_assert(CanvasCallbackPairArray_count(gui->canvas_callback_pair, p) == 1);
-    CanvasCallbackPairArray_remove_val(gui->canvas_callback_pair, p);
-    gui_unlock(gui);
+uint32_t gui_get_framebuffer_callback_lag(
+    Gui* gui,
+    GuiCanvasCommitCallback callback,
+    void* context) {
+    furi_assert(gui);
+
+    gui_framebuffer_lock(gui);
+    size_t index = gui_framebuffer_callback_find(gui, callback, context);
+    furi_assert(index < CanvasCallbackPairArray_size(gui->canvas_callback_pair));
+    uint32_t lag = CanvasCallbackPairArray_get(gui->canvas_callback_pair, index)->lag;
+    gui_framebuffer_unlock(gui);
+
+    return lag;
 }
 
-// size_t gui_get_framebuffer_size(Gui* gui) {
-//     furi_assert(gui);
-//     return canvas_get_buffer_size(gui->canvas);
-// }
+size_t gui_get_framebuffer_size(Gui* gui) {
+    furi_assert(gui);
+    return canvas_get_buffer_size(gui->canvas);
+}
 
 void gui_set_lockdown(Gui* gui, bool lockdown) {
     furi_assert(gui);
@@ -486,7 +609,19 @@ Gui* gui_alloc() {
     }
     // Drawing canvas
     gui->canvas = canvas_init();
+
+    // Framebuffer callbacks
     CanvasCallbackPairArray_init(gui->canvas_callback_pair);
+    gui->framebuffer_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    furi_check(gui->framebuffer_mutex);
+    gui->dispatch_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    furi_check(gui->dispatch_mutex);
+    gui->dispatch_thread = furi_thread_alloc();
+    furi_thread_set_name(gui->dispatch_thread, "GuiFramebuffer");
+    furi_thread_set_stack_size(gui->dispatch_thread, 1024 * 2);
+    furi_thread_set_context(gui->dispatch_thread, gui);
+    furi_thread_set_callback(gui->dispatch_thread, gui_framebuffer_dispatch);
+    furi_thread_start(gui->dispatch_thread);
 
     // Input
     gui->input_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
@@ -30,6 +30,12 @@ typedef enum {
 /** Gui Canvas Commit Callback */
 typedef void (*GuiCanvasCommitCallback)(uint8_t* data, size_t size, void* context);
 
+/** Frame delivery of a canvas commit callback */
+typedef enum {
+    GuiFramebufferPolicyLossless, /**< Every frame in order, unless the frame ring overflows */
+    GuiFramebufferPolicyLatest, /**< Only the newest frame, older pending ones are dropped */
+} GuiFramebufferPolicy;
+
 #define RECORD_GUI "gui"
 
 typedef struct Gui Gui;
@@ -73,8 +79,9 @@ void gui_view_port_send_to_back(Gui* gui, ViewPort* view_port);
 
 /** Add gui canvas commit callback
  *
- * This callback will be called upon Canvas commit Callback dispatched from GUI
- * thread and is time critical
+ * Committed frames are queued and the callback is called from the framebuffer
+ * dispatcher thread, so it does not hold up the GUI thread. Frames are delivered
+ * with GuiFramebufferPolicyLossless.
  *
  * @param      gui       Gui instance
  * @param      callback  GuiCanvasCommitCallback
@@ -82,7 +89,36 @@ void gui_view_port_send_to_back(Gui* gui, ViewPort* view_port);
  */
 void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context);
 
+/** Add gui canvas commit callback with frame delivery policy
+ *
+ * @param      gui       Gui instance
+ * @param      callback  GuiCanvasCommitCallback
+ * @param      context   GuiCanvasCommitCallback context
+ * @param      policy    GuiFramebufferPolicy
+ */
+void gui_add_framebuffer_callback_ex(
+    Gui* gui,
+    GuiCanvasCommitCallback callback,
+    void* context,
+    GuiFramebufferPolicy policy);
+
+/** Get number of frames a canvas commit callback missed
+ *
+ * @param      gui       Gui instance
+ * @param      callback  GuiCanvasCommitCallback
+ * @param      context   GuiCanvasCommitCallback context
+ *
+ * @return     frames committed but never delivered to the callback
+ */
+uint32_t gui_get_framebuffer_callback_lag(
+    Gui* gui,
+    GuiCanvasCommitCallback callback,
+    void* context);
+
 /** Remove gui canvas commit callback
+ *
+ * Waits for a call in progress to return, unless called from a callback, which may remove
+ * itself.
  *
  * @param      gui       Gui instance
  * @param      callback  GuiCanvasCommitCallback
@@ -41,19 +41,24 @@
 #define GUI_THREAD_FLAG_INPUT (1 << 1)
 #define GUI_THREAD_FLAG_ALL (GUI_THREAD_FLAG_DRAW | GUI_THREAD_FLAG_INPUT)
 
+#define GUI_DISPATCH_FLAG_FRAME (1 << 0)
+
+/* Committed frames kept for framebuffer callbacks that fall behind */
+#define GUI_FRAMEBUFFER_RING_SIZE 16
+#define GUI_FRAMEBUFFER_SIZE (GUI_DISPLAY_WIDTH * GUI_DISPLAY_HEIGHT / 8)
+
 ARRAY_DEF(ViewPortArray, ViewPort*, M_PTR_OPLIST);
 
 typedef struct {
     GuiCanvasCommitCallback callback;
     void* context;
+    GuiFramebufferPolicy policy;
+    uint32_t next_frame; /* sequence number of the next frame to deliver */
+    uint32_t lag; /* frames dropped for this callback */
 } CanvasCallbackPair;
 
 ARRAY_DEF(CanvasCallbackPairArray, CanvasCallbackPair, M_POD_OPLIST);
 
-#define M_OPL_CanvasCallbackPairArray_t() ARRAY_OPLIST(CanvasCallbackPairArray, M_POD_OPLIST)
-
-ALGO_DEF(CanvasCallbackPairArray, CanvasCallbackPairArray_t);
-
 /** Gui structure */
 struct Gui {
     // Thread and lock
@@ -64,7 +69,16 @@ struct Gui {
     bool lockdown;
     ViewPortArray_t layers[GuiLayerMAX];
     Canvas* canvas;
+
+    // Framebuffer callbacks, served from a ring of committed frames by the dispatcher thread.
+    // framebuffer_mutex guards the ring and callbacks, dispatch_mutex is held while one runs.
     CanvasCallbackPairArray_t canvas_callback_pair;
+    FuriThread* dispatch_thread;
+    FuriMutex* framebuffer_mutex;
+    FuriMutex* dispatch_mutex;
+    uint8_t frames[GUI_FRAMEBUFFER_RING_SIZE][GUI_FRAMEBUFFER_SIZE];
+    uint32_t frames_committed;
+    size_t dispatch_index;
 
     // Input
     FuriMessageQueue* input_queue;
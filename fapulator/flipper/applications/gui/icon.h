@@ -0,0 +1,44 @@
+/**
+ * @file icon.h
+ * GUI: Icon API
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Icon anonymous structure */
+typedef struct Icon Icon;
+
+/** Get icon width
+ *
+ * @param[in]  instance  pointer to Icon data
+ *
+ * @return     width in pixels
+ */
+uint8_t icon_get_width(const Icon* instance);
+
+/** Get icon height
+ *
+ * @param[in]  instance  pointer to Icon data
+ *
+ * @return     height in pixels
+ */
+uint8_t icon_get_height(const Icon* instance);
+
+/** Get Icon bitmap data of the first frame
+ * First byte tells if the rest is heatshrink compressed, otherwise it is plain XBM.
+ *
+ * @param[in]  instance  pointer to Icon data
+ *
+ * @return     pointer to bitmap data
+ */
+const uint8_t* icon_get_data(const Icon* instance);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include "gui.h"
 #include "gui_i.h"
 
+#ifdef CANVAS_COST_MODEL
+#include <applications/gui/canvas_cost.h>
+#endif
+
 // TODO add mutex to view_port ops
 
 _Static_assert(ViewPortOrientationMAX == 4, "Incorrect ViewPortOrientation count");
@@ -151,7 +155,13 @@ void view_port_draw(ViewPort* view_port, Canvas* canvas) {
 
     if(view_port->draw_callback) {
         view_port_setup_canvas_orientation(view_port, canvas);
+#ifdef CANVAS_COST_MODEL
+        canvas_cost_view_port_begin(canvas);
+#endif
         view_port->draw_callback(canvas, view_port->draw_callback_context);
+#ifdef CANVAS_COST_MODEL
+        canvas_cost_view_port_end(canvas, view_port, (const void*)view_port->draw_callback);
+#endif
     }
 }
 
@@ -1,7 +1,12 @@
 #include <thread>
+#include <chrono>
 #include <mutex>
-#include <bitset>
+#include <algorithm>
+#include <atomic>
+#include <utility>
 #include "hal/hal.h"
+#include "hal/display_expand.h"
+#include "hal/display_transfer.h"
 #include <input/input.h>
 #include <QtWidgets>
 #include <QImage>
@@ -15,10 +20,82 @@ typedef struct {
 static constexpr size_t DISPLAY_SCALE = 4;
 static constexpr size_t DISPLAY_WIDTH_SCALED = DISPLAY_WIDTH * DISPLAY_SCALE;
 static constexpr size_t DISPLAY_HEIGHT_SCALED = DISPLAY_HEIGHT * DISPLAY_SCALE;
+static constexpr auto DISPLAY_REFRESH_INTERVAL = std::chrono::milliseconds(16);
+
+static DisplayRegion display_region_union(const DisplayRegion& a, const DisplayRegion& b) {
+    if(a.width == 0 || a.height == 0) return b;
+    if(b.width == 0 || b.height == 0) return a;
+    size_t x = std::min(a.x, b.x);
+    size_t y = std::min(a.y, b.y);
+    size_t x_end = std::max(a.x + a.width, b.x + b.width);
+    size_t y_end = std::max(a.y + a.height, b.y + b.height);
+    return {x, y, x_end - x, y_end - y};
+}
+
+// Latest frame mailbox: GUI thread renders into `back`, Qt thread reads `front`, `ready` holds
+// the newest complete frame. Three slots whose owners swap them through one atomic, neither side
+// ever waits for the other.
+class DisplayFrames {
+private:
+    struct Slot {
+        DisplayFrame frame;
+        // Area changed since the frame the reader took before, covers the frames it dropped
+        DisplayRegion region;
+    };
+
+    // Slot index of `ready`, with FRESH set while the reader hasn't taken it
+    static constexpr uint8_t FRESH = 0x80;
+    static_assert(std::atomic<uint8_t>::is_always_lock_free, "Mailbox must not lock");
+
+    Slot slots[3] = {};
+    uint8_t back = 0; // GUI thread only
+    std::atomic<uint8_t> ready = 1;
+    uint8_t front = 2; // Qt thread only
+    // Region of the last published frame, GUI thread only
+    DisplayRegion published_region = {};
+    std::atomic<uint64_t> produced = 0;
+    std::atomic<uint64_t> presented = 0;
+    std::atomic<uint64_t> dropped = 0;
+
+public:
+    DisplayFrame* get_back() {
+        return &slots[back].frame;
+    }
+
+    void publish(const DisplayRegion& region) {
+        // The previous frame may still be dropped until the exchange below, carry its region
+        // unless the reader has already taken it
+        bool previous_pending = ready.load(std::memory_order_relaxed) & FRESH;
+        published_region =
+            previous_pending ? display_region_union(published_region, region) : region;
+        slots[back].region = published_region;
+
+        uint8_t previous = ready.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & ~FRESH;
+        produced.fetch_add(1, std::memory_order_relaxed);
+        if(previous & FRESH) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns false if no frame was published since the last call
+    bool acquire(const DisplayFrame** frame, DisplayRegion* region) {
+        if(!(ready.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = ready.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+        *frame = &slots[front].frame;
+        *region = slots[front].region;
+        presented.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void get_stats(DisplayFrameStats* stats) {
+        stats->produced = produced.load(std::memory_order_relaxed);
+        stats->presented = presented.load(std::memory_order_relaxed);
+        stats->dropped = dropped.load(std::memory_order_relaxed);
+    }
+};
 
-DisplayBuffer display_buffer_handler;
-static std::bitset<DISPLAY_WIDTH * DISPLAY_HEIGHT> display_buffer;
-static std::mutex display_buffer_mutex;
+static DisplayFrames display_frames;
 
 static std::mutex input_callback_mutex;
 static std::vector<InputCallbackRecord> input_callbacks;
@@ -42,20 +119,6 @@ bool get_key_from_button_name(const char* name, InputKey* key) {
     return false;
 }
 
-void DisplayBuffer::set_pixel(size_t x, size_t y, bool pixel) {
-    if(x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
-        display_buffer[(y * DISPLAY_WIDTH) + (x)] = pixel;
-    }
-}
-
-void DisplayBuffer::fill(bool value) {
-    if(value) {
-        display_buffer.set();
-    } else {
-        display_buffer.reset();
-    }
-}
-
 class HALEmulator;
 
 QApplication* main_app;
@@ -72,54 +135,57 @@ static Color color_reset = {0xFF, 0x82, 0x00};
 
 class DisplayWidget : public QWidget {
 private:
+    // Prescaled image, frames are expanded straight into it and painted without scaling
     QImage _image;
-    static const size_t buffer_colors = 3;
-    uchar _buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH][buffer_colors];
-
-    void set_pixel(size_t x, size_t y, bool pixel) {
-        if(pixel) {
-            _buffer[y][x][0] = color_set.r;
-            _buffer[y][x][1] = color_set.g;
-            _buffer[y][x][2] = color_set.b;
-        } else {
-            _buffer[y][x][0] = color_reset.r;
-            _buffer[y][x][1] = color_reset.g;
-            _buffer[y][x][2] = color_reset.b;
-        }
-    }
+    uint32_t _palette[2];
+    QTimer* _refresh_timer;
 
-    void copy_buffer_to_image() {
-        const std::lock_guard<std::mutex> lock(display_buffer_mutex);
-
-        // copy buffer to image
-        for(size_t y = 0; y < DISPLAY_HEIGHT; y++) {
-            for(size_t x = 0; x < DISPLAY_WIDTH; x++) {
-                bool bit = display_buffer[(y * DISPLAY_WIDTH) + (x)];
-                set_pixel(x, y, bit);
-            }
-        }
+    static uint32_t rgb32(const Color& color) {
+        return 0xFF000000 | color.r << 16 | color.g << 8 | color.b;
     }
 
 public:
     explicit DisplayWidget(QWidget* parent = 0) {
-        memset(_buffer, 0, DISPLAY_HEIGHT * DISPLAY_WIDTH * buffer_colors);
-        _image = QImage((uchar*)_buffer, DISPLAY_WIDTH, DISPLAY_HEIGHT, QImage::Format_RGB888);
+        _palette[0] = rgb32(color_reset);
+        _palette[1] = rgb32(color_set);
+        _image = QImage(DISPLAY_WIDTH_SCALED, DISPLAY_HEIGHT_SCALED, QImage::Format_RGB32);
+        _image.fill(_palette[0]);
+
+        // Runs on the Qt thread, picks up at most one frame per refresh
+        _refresh_timer = new QTimer(this);
+        _refresh_timer->setTimerType(Qt::PreciseTimer);
+        connect(_refresh_timer, &QTimer::timeout, this, &DisplayWidget::present);
+        _refresh_timer->start(DISPLAY_REFRESH_INTERVAL);
     }
 
     ~DisplayWidget(){
 
     };
 
-    void force_redraw() {
-        copy_buffer_to_image();
-        update();
+    // Newer frames replace unpresented ones, their changed areas are repainted together
+    void present() {
+        const DisplayFrame* frame;
+        DisplayRegion region;
+        if(!display_frames.acquire(&frame, &region)) return;
+
+        display_expand(
+            frame,
+            region,
+            _palette,
+            DISPLAY_SCALE,
+            (uint32_t*)_image.bits(),
+            _image.bytesPerLine() / sizeof(uint32_t));
+        update(
+            region.x * DISPLAY_SCALE,
+            region.y * DISPLAY_SCALE,
+            region.width * DISPLAY_SCALE,
+            region.height * DISPLAY_SCALE);
     }
 
 protected:
     void paintEvent(QPaintEvent* event) {
         QPainter painter(this);
-        painter.scale(DISPLAY_SCALE, DISPLAY_SCALE);
-        painter.drawImage(0, 0, this->_image);
+        painter.drawImage(event->rect().topLeft(), this->_image, event->rect());
     }
 };
 
@@ -294,31 +360,35 @@ public:
 
         setWindowTitle(QApplication::translate("halemulator", "FAPulator"));
         log_message("FAPulator started");
+        std::string kernel = std::string("Display expand kernel: ") + display_expand_kernel_name();
+        log_message(kernel.c_str());
     }
 
     ~HALEmulator() {
     }
 
-    void force_display_redraw() {
-        _display->force_redraw();
-    }
-
     void log_message(const char* message) {
         QMetaObject::invokeMethod(
             log, "appendHtml", Qt::QueuedConnection, Q_ARG(QString, QString(message)));
     }
 };
 
-DisplayBuffer* get_display_buffer() {
-    display_buffer_mutex.lock();
-    return &display_buffer_handler;
+DisplayFrame* get_display_buffer() {
+    return display_frames.get_back();
 }
 
-void commit_display_buffer(bool redraw) {
-    display_buffer_mutex.unlock();
-    if(redraw) {
-        hal_emulator->force_display_redraw();
-    }
+void commit_display_buffer(bool redraw, DisplayRegion region) {
+#ifdef DISPLAY_TRANSFER_MODEL
+    // The frame is on the device screen once the controller has received it
+    display_transfer_commit(region);
+#endif
+    // Nothing to repaint, the back buffer is rewritten by the next frame
+    if(!redraw) return;
+    display_frames.publish(region);
+}
+
+void get_display_frame_stats(DisplayFrameStats* stats) {
+    display_frames.get_stats(stats);
 }
 
 /***************************** Input *****************************/
@@ -5,12 +5,46 @@
 
 static constexpr size_t DISPLAY_WIDTH = 128;
 static constexpr size_t DISPLAY_HEIGHT = 64;
+static constexpr size_t DISPLAY_ROW_WORDS = DISPLAY_WIDTH / 64;
 
-class DisplayBuffer {
-public:
-    void set_pixel(size_t x, size_t y, bool value);
-    void fill(bool value);
-};
+/** Area of the display changed by a commit, empty if width or height is 0 */
+typedef struct {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+} DisplayRegion;
 
-DisplayBuffer* get_display_buffer();
-void commit_display_buffer(bool redraw);
\ No newline at end of file
+/** Display frame, pixel x of row y is bit (x % 64) of rows[y][x / 64] */
+typedef struct {
+    uint64_t rows[DISPLAY_HEIGHT][DISPLAY_ROW_WORDS];
+} DisplayFrame;
+
+/** Get back buffer to render the next frame into
+ * Must be called from a single thread, the frame belongs to the caller until
+ * commit_display_buffer. Contents are undefined, the whole frame must be written.
+ *
+ * @return     back buffer
+ */
+DisplayFrame* get_display_buffer();
+
+/** Publish frame taken by get_display_buffer, swaps buffers without copying or locking
+ * The display shows the newest published frame on its next refresh, frames published in
+ * between are dropped.
+ *
+ * @param      redraw  redraw display
+ * @param      region  area changed since the previous commit, only it is redrawn
+ */
+void commit_display_buffer(bool redraw, DisplayRegion region);
+
+typedef struct {
+    uint64_t produced; // frames published by commit_display_buffer
+    uint64_t presented; // frames the display picked up
+    uint64_t dropped; // frames replaced by a newer one before the display picked them up
+} DisplayFrameStats;
+
+/** Get frame counters, safe to call from any thread
+ *
+ * @param      stats  stats to fill
+ */
+void get_display_frame_stats(DisplayFrameStats* stats);
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include "display.h"
+
+/** Expand region of a 1bpp frame into a 32 bit image scaled by `scale`
+ * Pixels are written as palette[0] for reset and palette[1] for set bits, each display pixel
+ * becomes a scale x scale block. The image must hold DISPLAY_WIDTH x DISPLAY_HEIGHT blocks.
+ *
+ * @param      frame         display frame
+ * @param      region        area to expand, in display pixels
+ * @param      palette       reset and set colors
+ * @param      scale         block size in image pixels
+ * @param      image         first pixel of the image
+ * @param      image_stride  image row length in pixels
+ */
+void display_expand(
+    const DisplayFrame* frame,
+    const DisplayRegion& region,
+    const uint32_t palette[2],
+    size_t scale,
+    uint32_t* image,
+    size_t image_stride);
+
+/** Get name of the expand kernel picked for this CPU
+ *
+ * @return     "avx2", "sse2" or "scalar"
+ */
+const char* display_expand_kernel_name();
\ No newline at end of file
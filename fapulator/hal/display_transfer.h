@@ -0,0 +1,69 @@
+#pragma once
+#include "display.h"
+
+// Defaults of the Flipper ST7565-class LCD, overridable from CMake
+#ifndef DISPLAY_TRANSFER_BUS_HZ
+#define DISPLAY_TRANSFER_BUS_HZ 4000000
+#endif
+
+#ifndef DISPLAY_TRANSFER_PARTIAL_PAGES
+#define DISPLAY_TRANSFER_PARTIAL_PAGES 0
+#endif
+
+#ifndef DISPLAY_TRANSFER_THROTTLE
+#define DISPLAY_TRANSFER_THROTTLE 0
+#endif
+
+// The controller takes the frame as pages of 8 rows, one byte per column
+static constexpr size_t DISPLAY_PAGE_HEIGHT = 8;
+static constexpr size_t DISPLAY_PAGES = DISPLAY_HEIGHT / DISPLAY_PAGE_HEIGHT;
+
+/** Bus and controller parameters of a frame transfer */
+typedef struct {
+    uint32_t bus_hz; /**< SPI clock */
+    uint32_t page_command_bytes; /**< page and column address commands before each page */
+    uint32_t page_overhead_ns; /**< chip select, data/command switch and driver call per page */
+    /** Send only the columns of changed pages, the controller allows it but u8g2 sends the
+     * whole buffer on every commit */
+    bool partial_pages;
+    /** Hold the committing thread for the modeled transfer, like the blocking SPI write */
+    bool throttle;
+} DisplayTransferConfig;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t pages; // pages sent
+    uint64_t bytes; // command and data bytes sent
+    uint64_t transfer_ns; // bus time of all frames
+    uint64_t transfer_ns_max;
+    uint64_t throttle_ns; // time commits were held with throttle on
+} DisplayTransferStats;
+
+/** Get transfer parameters
+ *
+ * @param      config  config to fill
+ */
+void display_transfer_get_config(DisplayTransferConfig* config);
+
+/** Set transfer parameters
+ *
+ * @param      config  transfer parameters
+ */
+void display_transfer_set_config(const DisplayTransferConfig* config);
+
+/** Model the transfer of a committed frame
+ * Counts the pages and bytes the controller receives and the bus time they take. With throttle
+ * on, returns once the transfer would be done, so commits never outpace the display. Logs the
+ * achievable frame rate about once per second.
+ *
+ * @param      region  area changed since the previous commit, only used with partial pages
+ *
+ * @return     modeled transfer time in nanoseconds
+ */
+uint64_t display_transfer_commit(const DisplayRegion& region);
+
+/** Get transfer counters
+ *
+ * @param      stats  stats to fill
+ */
+void display_transfer_get_stats(DisplayTransferStats* stats);
\ No newline at end of file
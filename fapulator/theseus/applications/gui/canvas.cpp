@@ -1,9 +1,18 @@
 #include <gui/canvas.h>
 #include <gui/canvas_i.h>
-#include <bitset>
+#include <gui/icon_i.h>
+#include <gui/icon_animation_i.h>
+#include <algorithm>
+#include <cstdlib>
+#include <bit>
+#include <type_traits>
+#include <vector>
+#include <string.h>
 #include <hal/display.h>
 #include "font/fonts.h"
+#include "font/glyph_cache.h"
 #include "font/u8g2_font_render.h"
+#include "icon_cache.h"
 
 #define U8G2_DRAW_UPPER_RIGHT 0x01
 #define U8G2_DRAW_UPPER_LEFT 0x02
@@ -12,60 +21,801 @@
 #define U8G2_DRAW_ALL \
     (U8G2_DRAW_UPPER_RIGHT | U8G2_DRAW_UPPER_LEFT | U8G2_DRAW_LOWER_RIGHT | U8G2_DRAW_LOWER_LEFT)
 
+// Maps logical canvas pixels to the display: logical axes are mirrored first, then swapped
+template <bool Transposed, bool MirrorX, bool MirrorY>
+struct CanvasTransform {
+    static constexpr bool transposed = Transposed;
+    static constexpr bool mirror_x = MirrorX;
+    static constexpr bool mirror_y = MirrorY;
+    // Logical canvas size
+    static constexpr size_t width = Transposed ? DISPLAY_HEIGHT : DISPLAY_WIDTH;
+    static constexpr size_t height = Transposed ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+
+    static constexpr size_t display_x(size_t x, size_t y) {
+        return Transposed ? (MirrorY ? height - 1 - y : y) : (MirrorX ? width - 1 - x : x);
+    }
+
+    static constexpr size_t display_y(size_t x, size_t y) {
+        return Transposed ? (MirrorX ? width - 1 - x : x) : (MirrorY ? height - 1 - y : y);
+    }
+};
+
+#ifdef CANVAS_COST_MODEL
+static constexpr bool CANVAS_COST_ENABLED = true;
+#else
+static constexpr bool CANVAS_COST_ENABLED = false;
+#endif
+
+// Same mappings as the u8g2 display rotations Flipper firmware uses for each orientation
+using CanvasHorizontal = CanvasTransform<false, false, false>; // U8G2_R0, x, y
+using CanvasHorizontalFlip = CanvasTransform<false, true, true>; // U8G2_R2, 127 - x, 63 - y
+using CanvasVertical = CanvasTransform<true, true, false>; // U8G2_R3, y, 63 - x
+using CanvasVerticalFlip = CanvasTransform<true, false, true>; // U8G2_R1, 127 - y, x
+
 class CanvasInstance {
 private:
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t ROW_WORDS = DISPLAY_WIDTH / WORD_BITS;
+    static_assert(DISPLAY_WIDTH % WORD_BITS == 0, "Display width must be a multiple of 64");
+
     Canvas* canvas;
-    std::bitset<DISPLAY_WIDTH * DISPLAY_HEIGHT> display_buffer;
+    // Row-major framebuffer, pixel x of row y is bit (x % 64) of buffer[y][x / 64]
+    uint64_t buffer[DISPLAY_HEIGHT][ROW_WORDS];
+    // Framebuffer as of the last commit, used to find changed pixels
+    uint64_t committed[DISPLAY_HEIGHT][ROW_WORDS];
+    bool committed_valid = false;
+    // Framebuffer in the u8g2 page layout of the display: byte x of page p holds column x of
+    // rows 8p to 8p + 7, lowest bit on top. Converted from `buffer` when asked for.
+    uint8_t pages[DISPLAY_HEIGHT / 8][DISPLAY_WIDTH];
+    bool pages_valid = false;
     Color color = ColorBlack;
     CanvasDirection font_direction = CanvasDirectionLeftToRight;
+    bool bitmap_transparent = false;
     const uint8_t* font = u8g2_font_haxrcorp4089_tr;
+    // Metrics of `font`, refreshed when the font changes
+    const FontMetrics* font_metrics = font_get_metrics(font);
+    // Glyphs of `font`, resolved when it is set so glyph lookups never search the fonts
+    FontGlyphCache* font_glyphs = glyph_cache_get_font(font);
+
+    // Primitives instantiated for one orientation and color. Strings and bitmaps blend every word
+    // from an image anyway and read the color at run time.
+    struct Writer {
+        void (CanvasInstance::*draw_string)(uint16_t x, uint16_t y, const char* text);
+        void (CanvasInstance::*draw_xbm)(uint8_t, uint8_t, uint8_t, uint8_t, const uint8_t*);
+        void (CanvasInstance::*draw_line)(uint8_t, uint8_t, uint8_t, uint8_t);
+        void (CanvasInstance::*draw_triangle_filled)(
+            uint8_t,
+            uint8_t,
+            uint8_t,
+            uint8_t,
+            uint8_t,
+            uint8_t);
+        void (CanvasInstance::*draw_circle)(uint8_t, uint8_t, uint8_t, uint8_t);
+        void (CanvasInstance::*draw_disc)(uint8_t, uint8_t, uint8_t, uint8_t);
+        void (CanvasInstance::*draw_box)(uint8_t, uint8_t, uint8_t, uint8_t);
+        void (CanvasInstance::*draw_frame)(uint8_t, uint8_t, uint8_t, uint8_t);
+        void (CanvasInstance::*draw_rounded_box)(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t);
+        void (CanvasInstance::*draw_rounded_frame)(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t);
+    };
+
+    template <typename O, Color C>
+    static const Writer* get_writer() {
+        static constexpr Writer writer = {
+            &CanvasInstance::draw_string<O>,
+            &CanvasInstance::draw_xbm<O>,
+            &CanvasInstance::draw_line<O, C>,
+            &CanvasInstance::draw_triangle_filled<O, C>,
+            &CanvasInstance::draw_circle<O, C>,
+            &CanvasInstance::draw_disc<O, C>,
+            &CanvasInstance::draw_box<O, C>,
+            &CanvasInstance::draw_frame<O, C>,
+            &CanvasInstance::draw_rounded_box<O, C>,
+            &CanvasInstance::draw_rounded_frame<O, C>,
+        };
+        return &writer;
+    }
+
+    template <typename O>
+    static const Writer* get_writer(Color color) {
+        switch(color) {
+        case ColorBlack:
+            return get_writer<O, ColorBlack>();
+        case ColorWhite:
+            return get_writer<O, ColorWhite>();
+        case ColorXOR:
+            return get_writer<O, ColorXOR>();
+        default:
+            abort();
+        }
+    }
+
+    // Picked once per orientation or color change, so primitives never branch on either
+    const Writer* writer = get_writer<CanvasHorizontal, ColorBlack>();
+    // Logical canvas size of the current orientation
+    size_t canvas_width = DISPLAY_WIDTH;
+    size_t canvas_height = DISPLAY_HEIGHT;
+
+    // Frame from canvas_frame_set cut to the canvas, in logical coordinates. Primitives never
+    // touch pixels outside of it.
+    size_t clip_x_start = 0;
+    size_t clip_y_start = 0;
+    size_t clip_x_end = DISPLAY_WIDTH;
+    size_t clip_y_end = DISPLAY_HEIGHT;
+    // Clip columns of each row word, for rasterizers working in display space
+    uint64_t clip_mask[ROW_WORDS];
+    CanvasOrientation orientation = CanvasOrientationHorizontal;
+
+    // Pixel operations of the display list
+    enum class CommandType : uint8_t {
+        Fill,
+        String,
+        Xbm,
+        Line,
+        TriangleFilled,
+        Circle,
+        Disc,
+        Box,
+        Frame,
+        RoundedBox,
+        RoundedFrame,
+    };
+
+    // Everything besides arguments that decides which pixels a command touches
+    struct DrawState {
+        Color color;
+        bool bitmap_transparent;
+        CanvasOrientation orientation;
+        uint8_t clip[4];
+        const uint8_t* font;
+    };
+
+    struct Command {
+        CommandType type;
+        uint8_t args[6];
+        DrawState state;
+        // String or bitmap copied into the display list data
+        size_t data_offset;
+        size_t data_size;
+    };
+
+    // When recording, pixel operations are kept until commit, where a frame hashing the same as
+    // the last drawn one is dropped without being rasterized or sent
+    bool display_list_enabled = false;
+    std::vector<Command> display_list;
+    std::vector<uint8_t> display_list_data;
+    uint64_t display_list_hash = 0;
+    bool display_list_hash_valid = false;
+    CanvasDisplayListStats display_list_stats = {};
+
+    // A clear only queues the rows drawn on since the previous one, they are zeroed right before
+    // something else draws or reads them. Rows an opaque full width box overwrites first are
+    // never zeroed.
+    static_assert(DISPLAY_HEIGHT <= 64, "Row masks hold one bit per display row");
+    // Rows that may hold set pixels, not counting pending ones
+    uint64_t rows_dirty = 0;
+    // Rows waiting to be zeroed
+    uint64_t rows_pending = 0;
+    CanvasClearCounters clear_counters = {};
+    CanvasClearStats clear_stats = {};
+    CanvasCostCounters cost_counters = {};
+
+    // Compiled out unless the cost model is enabled
+    void count_cost(uint32_t CanvasCostCounters::*counter, uint32_t count) {
+        if constexpr(CANVAS_COST_ENABLED) {
+            cost_counters.*counter += count;
+        }
+    }
+
+    bool clip_row(size_t y) const {
+        return y >= clip_y_start && y < clip_y_end;
+    }
+
+    bool clip_column(size_t x) const {
+        return x >= clip_x_start && x < clip_x_end;
+    }
+
+    // Whole primitive rejection, box is [x_start, x_end] x [y_start, y_end] inclusive
+    bool clip_rejects(int x_start, int y_start, int x_end, int y_end) const {
+        return x_end < (int)clip_x_start || x_start >= (int)clip_x_end ||
+               y_end < (int)clip_y_start || y_start >= (int)clip_y_end;
+    }
+
+    // Box is [x_start, x_end] x [y_start, y_end] inclusive
+    bool clip_contains(int x_start, int y_start, int x_end, int y_end) const {
+        return x_start >= (int)clip_x_start && x_end < (int)clip_x_end &&
+               y_start >= (int)clip_y_start && y_end < (int)clip_y_end;
+    }
+
+    // Keep bits of a run of pixels starting at x that fall in [start, end)
+    static uint64_t clip_run(uint64_t mask, int x, size_t start, size_t end) {
+        int first = std::max((int)start - x, 0);
+        int last = std::min((int)end - x, (int)WORD_BITS);
+        if(first >= last) return 0;
+        return mask & word_mask(first, last);
+    }
+
+    static uint64_t word_mask(size_t x_start, size_t x_end) {
+        // Bits [x_start, x_end) of a single word, x_end is in range (x_start, 64]
+        uint64_t mask = ~0ULL << x_start;
+        if(x_end < WORD_BITS) {
+            mask &= ~(~0ULL << x_end);
+        }
+        return mask;
+    }
+
+    template <Color C>
+    void apply_mask(uint64_t& word, uint64_t mask) {
+        count_cost(&CanvasCostCounters::pixels, std::popcount(mask));
+        if constexpr(C == ColorBlack) {
+            word |= mask;
+        } else if constexpr(C == ColorWhite) {
+            word &= ~mask;
+        } else {
+            word ^= mask;
+        }
+    }
+
+    // Display rows [y_start, y_end)
+    static uint64_t row_mask(size_t y_start, size_t y_end) {
+        return (y_end - y_start == 64 ? ~0ULL : (1ULL << (y_end - y_start)) - 1) << y_start;
+    }
+
+    // Zeroes each run of adjacent rows with one memset
+    void zero_rows(uint64_t rows) {
+        clear_counters.rows_cleared += std::popcount(rows);
+        while(rows) {
+            size_t start = std::countr_zero(rows);
+            size_t count = std::countr_one(rows >> start);
+            memset(buffer[start], 0, count * sizeof(buffer[0]));
+            rows &= ~row_mask(start, start + count);
+        }
+    }
+
+    [[gnu::noinline]] void zero_pending_rows() {
+        zero_rows(rows_pending);
+        rows_pending = 0;
+    }
+
+    void flush_clear() {
+        if(rows_pending) zero_pending_rows();
+    }
+
+    // Rows a rect is about to draw on that are pending or still clean, out of line to keep
+    // fill_display_rect small
+    [[gnu::noinline]] void track_rect_rows(uint64_t rows, bool covered, Color color) {
+        if(covered) {
+            clear_counters.rows_covered += std::popcount(rows_pending & rows);
+        } else {
+            zero_rows(rows_pending & rows);
+        }
+        rows_pending &= ~rows;
+        if(color != ColorWhite) {
+            rows_dirty |= rows;
+        }
+    }
+
+    // Fill clipped span [x_start, x_end) of display rows [y_start, y_end). Inlined so each
+    // primitive gets a loop specialized to its span.
+    template <Color C>
+    [[gnu::always_inline]] void
+        fill_display_rect(size_t x_start, size_t x_end, size_t y_start, size_t y_end) {
+        // Drawing over dirty rows, the usual case, needs no bookkeeping
+        uint64_t rows = row_mask(y_start, y_end);
+        if((rows_pending | ~rows_dirty) & rows) {
+            track_rect_rows(rows, x_start == 0 && x_end == DISPLAY_WIDTH && C != ColorXOR, C);
+        }
+
+        size_t first_word = x_start / WORD_BITS;
+        size_t last_word = (x_end - 1) / WORD_BITS;
+        uint64_t first_mask = word_mask(x_start % WORD_BITS, WORD_BITS);
+        uint64_t last_mask = word_mask(0, (x_end - 1) % WORD_BITS + 1);
+
+        if(first_word == last_word) {
+            first_mask &= last_mask;
+        }
+
+        for(size_t y = y_start; y < y_end; y++) {
+            uint64_t* row = buffer[y];
+            apply_mask<C>(row[first_word], first_mask);
+            if(first_word != last_word) {
+                for(size_t i = first_word + 1; i < last_word; i++) {
+                    apply_mask<C>(row[i], ~0ULL);
+                }
+                apply_mask<C>(row[last_word], last_mask);
+            }
+        }
+    }
+
+    // Clipped logical rectangle, an axis aligned rectangle stays one in every orientation
+    template <typename O, Color C>
+    [[gnu::always_inline]] void
+        fill_rect(size_t x_start, size_t x_end, size_t y_start, size_t y_end) {
+        if constexpr(O::mirror_x) {
+            size_t mirrored_start = O::width - x_end;
+            x_end = O::width - x_start;
+            x_start = mirrored_start;
+        }
+        if constexpr(O::mirror_y) {
+            size_t mirrored_start = O::height - y_end;
+            y_end = O::height - y_start;
+            y_start = mirrored_start;
+        }
+        if constexpr(O::transposed) {
+            fill_display_rect<C>(y_start, y_end, x_start, x_end);
+        } else {
+            fill_display_rect<C>(x_start, x_end, y_start, y_end);
+        }
+    }
+
+    // Pixels in `clear` are reset, then pixels in `toggle` are flipped
+    void blend(uint64_t& word, uint64_t clear, uint64_t toggle) {
+        count_cost(&CanvasCostCounters::pixels, std::popcount(clear | toggle));
+        word = (word & ~clear) ^ toggle;
+    }
+
+    // Blend masks writing `mask` pixels of an image: set bits get color, clear bits get the
+    // opposite one. Clear bits of a XOR image are reset like u8g2 drawing them in color 0.
+    static void image_masks(
+        uint64_t bits,
+        uint64_t mask,
+        Color color,
+        uint64_t& clear,
+        uint64_t& toggle) {
+        clear = color == ColorXOR ? ~bits & mask : mask;
+        toggle = (color == ColorWhite ? ~bits : bits) & mask;
+    }
+
+    static uint64_t reverse_bits(uint64_t bits) {
+        bits = ((bits >> 1) & 0x5555555555555555ULL) | ((bits & 0x5555555555555555ULL) << 1);
+        bits = ((bits >> 2) & 0x3333333333333333ULL) | ((bits & 0x3333333333333333ULL) << 2);
+        bits = ((bits >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((bits & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        return __builtin_bswap64(bits);
+    }
+
+    // Blend 64 pixels of display row y starting at x, pixels outside the row are dropped
+    void blend_display_row(size_t y, int x, uint64_t clear, uint64_t toggle) {
+        if(x < 0) {
+            if(x <= -(int)WORD_BITS) return;
+            clear >>= -x;
+            toggle >>= -x;
+            x = 0;
+        }
+        if(x >= (int)DISPLAY_WIDTH) return;
+
+        rows_dirty |= 1ULL << y;
+        uint64_t* row = buffer[y];
+        size_t word = x / WORD_BITS;
+        size_t shift = x % WORD_BITS;
+        blend(row[word], clear << shift, toggle << shift);
+        if(shift && word + 1 < ROW_WORDS) {
+            blend(row[word + 1], clear >> (WORD_BITS - shift), toggle >> (WORD_BITS - shift));
+        }
+    }
+
+    template <typename O, Color C>
+    void write_pixel(size_t x, size_t y) {
+        size_t display_x = O::display_x(x, y);
+        size_t display_y = O::display_y(x, y);
+        rows_dirty |= 1ULL << display_y;
+        apply_mask<C>(buffer[display_y][display_x / WORD_BITS], 1ULL << (display_x % WORD_BITS));
+    }
+
+    // Write `mask` pixels of row y starting at x: set bits get color, clear bits get the
+    // opposite color or are left as is when transparent
+    template <typename O>
+    void write_row_bits(
+        size_t y,
+        int x,
+        uint64_t bits,
+        uint64_t mask,
+        Color color,
+        bool transparent) {
+        if(transparent) {
+            mask &= bits;
+        }
+
+        static_assert(!O::transposed, "Transposed images are written by columns");
+        mask = clip_run(mask, x, clip_x_start, clip_x_end);
+        if(mask == 0) return;
+        uint64_t clear, toggle;
+        image_masks(bits, mask, color, clear, toggle);
+        if constexpr(O::mirror_x) {
+            // Row runs right to left on the display
+            blend_display_row(
+                O::display_y(0, y),
+                (int)O::width - (int)WORD_BITS - x,
+                reverse_bits(clear),
+                reverse_bits(toggle));
+        } else {
+            blend_display_row(O::display_y(0, y), x, clear, toggle);
+        }
+    }
+
+    // Write pixels of logical column x going down from row y, bit k is row y + k. Transposed
+    // orientations store logical columns as display rows.
+    template <typename O>
+    void write_column_bits(
+        int x,
+        int y,
+        uint64_t bits,
+        uint64_t mask,
+        Color color,
+        bool transparent) {
+        static_assert(O::transposed, "Columns are only contiguous in transposed orientations");
+        if(x < 0 || !clip_column(x)) return;
+        mask = clip_run(mask, y, clip_y_start, clip_y_end);
+        if(mask == 0) return;
+        if(transparent) {
+            mask &= bits;
+        }
+        uint64_t clear, toggle;
+        image_masks(bits, mask, color, clear, toggle);
+
+        size_t row = O::display_y(x, 0);
+        if constexpr(O::mirror_y) {
+            blend_display_row(
+                row,
+                (int)O::height - (int)WORD_BITS - y,
+                reverse_bits(clear),
+                reverse_bits(toggle));
+        } else {
+            blend_display_row(row, y, clear, toggle);
+        }
+    }
+
+    // Transpose an 8x8 bit block, bit (8 * i + j) swaps with bit (8 * j + i)
+    static uint64_t transpose_block(uint64_t block) {
+        uint64_t t = (block ^ (block >> 7)) & 0x00AA00AA00AA00AAULL;
+        block ^= t ^ (t << 7);
+        t = (block ^ (block >> 14)) & 0x0000CCCC0000CCCCULL;
+        block ^= t ^ (t << 14);
+        t = (block ^ (block >> 28)) & 0x00000000F0F0F0F0ULL;
+        block ^= t ^ (t << 28);
+        return block;
+    }
+
+    static uint64_t load_row_bits(const uint8_t* data, size_t bytes) {
+        uint64_t bits = 0;
+        for(size_t i = 0; i < bytes; i++) {
+            bits |= (uint64_t)data[i] << (i * 8);
+        }
+        return bits;
+    }
+
+    // 8 bit coordinate of a box that may wrap around the zero edge
+    static int wrap_coordinate(uint8_t position, uint8_t size) {
+        return position + size > UINT8_MAX + 1 ? position - (UINT8_MAX + 1) : position;
+    }
+
+    // Blit for transposed orientations: 8x8 tiles are transposed and stacked into columns of up
+    // to 64 pixels, each column is a single display row write
+    template <typename O>
+    void draw_bit_tiles(
+        int x,
+        int y,
+        size_t width,
+        size_t height,
+        size_t stride,
+        const uint8_t* data,
+        bool transparent) {
+        for(size_t row = 0; row < height; row += WORD_BITS) {
+            int chunk_y = y + (int)row;
+            if(chunk_y >= (int)clip_y_end) break;
+            size_t chunk_rows = std::min<size_t>(height - row, WORD_BITS);
+            if(chunk_y + (int)chunk_rows <= (int)clip_y_start) continue;
+            uint64_t mask = word_mask(0, chunk_rows);
+
+            for(size_t byte = 0; byte < stride; byte++) {
+                int tile_x = x + (int)byte * 8;
+                if(tile_x >= (int)clip_x_end) break;
+                if(tile_x + 8 <= (int)clip_x_start) continue;
+
+                uint64_t columns[8] = {};
+                for(size_t tile = 0; tile < chunk_rows; tile += 8) {
+                    const uint8_t* tile_data = data + (row + tile) * stride + byte;
+                    size_t tile_rows = std::min<size_t>(chunk_rows - tile, 8);
+                    uint64_t block = 0;
+                    for(size_t i = 0; i < tile_rows; i++) {
+                        block |= (uint64_t)tile_data[i * stride] << (i * 8);
+                    }
+                    block = transpose_block(block);
+                    for(size_t i = 0; i < 8; i++) {
+                        columns[i] |= ((block >> (i * 8)) & 0xFF) << tile;
+                    }
+                }
+
+                size_t tile_columns = std::min<size_t>(width - byte * 8, 8);
+                for(size_t i = 0; i < tile_columns; i++) {
+                    write_column_bits<O>(
+                        tile_x + i, chunk_y, columns[i], mask, color, transparent);
+                }
+            }
+        }
+    }
+
+    // Row-wise blit, each image row is written as 64 bit chunks
+    template <typename O>
+    void draw_bit_rows(
+        int x,
+        int y,
+        size_t width,
+        size_t height,
+        size_t stride,
+        const uint8_t* data,
+        bool transparent) {
+        for(size_t row = 0; row < height; row++, data += stride) {
+            int row_y = y + (int)row;
+            if(row_y < (int)clip_y_start) continue;
+            if(row_y >= (int)clip_y_end) break;
+
+            for(size_t chunk = 0; chunk < width; chunk += WORD_BITS) {
+                size_t chunk_width = std::min<size_t>(width - chunk, WORD_BITS);
+                size_t chunk_bytes = std::min<size_t>(stride - chunk / 8, 8);
+                uint64_t bits = load_row_bits(data + chunk / 8, chunk_bytes);
+                uint64_t mask = word_mask(0, chunk_width);
+                write_row_bits<O>(row_y, x + (int)chunk, bits, mask, color, transparent);
+            }
+        }
+    }
+
+    // Blit of a 1bpp image, pixel x of a row is bit (x % 8) of byte x / 8
+    template <typename O>
+    void draw_bits(
+        int x,
+        int y,
+        size_t width,
+        size_t height,
+        size_t stride,
+        const uint8_t* data,
+        bool transparent) {
+        if(clip_rejects(x, y, x + (int)width - 1, y + (int)height - 1)) return;
+        if constexpr(O::transposed) {
+            draw_bit_tiles<O>(x, y, width, height, stride, data, transparent);
+        } else {
+            draw_bit_rows<O>(x, y, width, height, stride, data, transparent);
+        }
+    }
+
+    template <typename O>
+    void draw_glyph(int x, int y, const GlyphBitmap* glyph) {
+        draw_bits<O>(x, y, glyph->width, glyph->height, glyph->stride, glyph->bitmap, false);
+    }
+
+    void fill_buffer(bool value) {
+        if(value) {
+            memset(buffer, 0xFF, sizeof(buffer));
+            rows_dirty = row_mask(0, DISPLAY_HEIGHT);
+            rows_pending = 0;
+        } else {
+            clear_counters.clears++;
+            clear_counters.rows_clean += DISPLAY_HEIGHT - std::popcount(rows_dirty);
+            rows_pending |= rows_dirty;
+            rows_dirty = 0;
+        }
+    }
+
+    void update_clip_mask() {
+        for(size_t i = 0; i < ROW_WORDS; i++) {
+            size_t start = std::clamp(clip_x_start, i * WORD_BITS, (i + 1) * WORD_BITS);
+            size_t end = std::clamp(clip_x_end, i * WORD_BITS, (i + 1) * WORD_BITS);
+            clip_mask[i] = start < end ? word_mask(start - i * WORD_BITS, end - i * WORD_BITS) :
+                                         0;
+        }
+    }
+
+    DrawState get_draw_state() {
+        return {
+            color,
+            bitmap_transparent,
+            orientation,
+            {(uint8_t)clip_x_start,
+             (uint8_t)clip_y_start,
+             (uint8_t)clip_x_end,
+             (uint8_t)clip_y_end},
+            font,
+        };
+    }
+
+    void set_draw_state(const DrawState& state) {
+        if(state.color != color) {
+            set_color(state.color);
+        }
+        bitmap_transparent = state.bitmap_transparent;
+        if(state.font != font) {
+            set_font(state.font);
+        }
+        if(state.orientation != orientation) {
+            set_orientation(state.orientation);
+        }
+        if(state.clip[0] != clip_x_start || state.clip[1] != clip_y_start ||
+           state.clip[2] != clip_x_end || state.clip[3] != clip_y_end) {
+            clip_x_start = state.clip[0];
+            clip_y_start = state.clip[1];
+            clip_x_end = state.clip[2];
+            clip_y_end = state.clip[3];
+            update_clip_mask();
+        }
+    }
+
+    // Run before every pixel operation, drawn directly or replayed
+    void begin_command(CommandType type) {
+        pages_valid = false;
+        // Boxes settle pending rows themselves, so full width ones can skip zeroing
+        if(type != CommandType::Fill && type != CommandType::Box) {
+            flush_clear();
+        }
+    }
+
+    void count_command(CommandType type) {
+        if(type == CommandType::Fill) {
+            count_cost(&CanvasCostCounters::clears, 1);
+        } else {
+            count_cost(&CanvasCostCounters::primitives, 1);
+        }
+    }
+
+    // Drawing without a display list skips this and calls the writer directly
+    void execute(const Command& command, const uint8_t* data) {
+        const uint8_t* a = command.args;
+        begin_command(command.type);
+        switch(command.type) {
+        case CommandType::Fill:
+            fill_buffer(a[0]);
+            break;
+        case CommandType::String:
+            (this->*writer->draw_string)(a[0], a[1], (const char*)data);
+            break;
+        case CommandType::Xbm:
+            (this->*writer->draw_xbm)(a[0], a[1], a[2], a[3], data);
+            break;
+        case CommandType::Line:
+            (this->*writer->draw_line)(a[0], a[1], a[2], a[3]);
+            break;
+        case CommandType::TriangleFilled:
+            (this->*writer->draw_triangle_filled)(a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+        case CommandType::Circle:
+            (this->*writer->draw_circle)(a[0], a[1], a[2], a[3]);
+            break;
+        case CommandType::Disc:
+            (this->*writer->draw_disc)(a[0], a[1], a[2], a[3]);
+            break;
+        case CommandType::Box:
+            (this->*writer->draw_box)(a[0], a[1], a[2], a[3]);
+            break;
+        case CommandType::Frame:
+            (this->*writer->draw_frame)(a[0], a[1], a[2], a[3]);
+            break;
+        case CommandType::RoundedBox:
+            (this->*writer->draw_rounded_box)(a[0], a[1], a[2], a[3], a[4]);
+            break;
+        case CommandType::RoundedFrame:
+            (this->*writer->draw_rounded_frame)(a[0], a[1], a[2], a[3], a[4]);
+            break;
+        }
+    }
+
+    // Records the command with a copy of its data, drawn on commit
+    void record(
+        CommandType type,
+        std::initializer_list<uint8_t> args,
+        const void* data = nullptr,
+        size_t data_size = 0) {
+        Command command = {};
+        command.type = type;
+        std::copy(args.begin(), args.end(), command.args);
+        count_command(type);
+
+        command.state = get_draw_state();
+        command.data_offset = display_list_data.size();
+        command.data_size = data_size;
+        const uint8_t* bytes = (const uint8_t*)data;
+        display_list_data.insert(display_list_data.end(), bytes, bytes + data_size);
+        display_list.push_back(command);
+    }
+
+    // FNV-1a
+    static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for(size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    uint64_t hash_display_list() {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for(const Command& command : display_list) {
+            const DrawState& state = command.state;
+            hash = hash_bytes(hash, &command.type, sizeof(command.type));
+            hash = hash_bytes(hash, command.args, sizeof(command.args));
+            hash = hash_bytes(hash, &state.color, sizeof(state.color));
+            hash = hash_bytes(hash, &state.bitmap_transparent, sizeof(state.bitmap_transparent));
+            hash = hash_bytes(hash, &state.orientation, sizeof(state.orientation));
+            hash = hash_bytes(hash, state.clip, sizeof(state.clip));
+            hash = hash_bytes(hash, &state.font, sizeof(state.font));
+            hash = hash_bytes(
+                hash, display_list_data.data() + command.data_offset, command.data_size);
+        }
+        return hash;
+    }
+
+    void replay_display_list() {
+        DrawState state = get_draw_state();
+        for(const Command& command : display_list) {
+            set_draw_state(command.state);
+            execute(command, display_list_data.data() + command.data_offset);
+        }
+        set_draw_state(state);
+        display_list.clear();
+        display_list_data.clear();
+    }
 
 public:
     CanvasInstance(Canvas* _canvas) {
         canvas = _canvas;
+        memset(buffer, 0, sizeof(buffer));
+        set_clip(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
     }
 
     ~CanvasInstance() {
     }
 
     void fill(bool value) {
-        if(value) {
-            display_buffer.set();
-        } else {
-            display_buffer.reset();
+        if(display_list_enabled) {
+            record(CommandType::Fill, {value});
+            return;
         }
+        count_command(CommandType::Fill);
+        begin_command(CommandType::Fill);
+        fill_buffer(value);
     }
 
+    template <typename O, Color C>
     void set_pixel(size_t x, size_t y) {
-        if(x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
-            display_buffer.set(x + y * DISPLAY_WIDTH, color);
+        if(clip_column(x) && clip_row(y)) {
+            write_pixel<O, C>(x, y);
         }
     }
 
-    void clear_pixel(size_t x, size_t y) {
-        if(x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
-            display_buffer.set(x + y * DISPLAY_WIDTH, !color);
-        }
+    template <typename O, Color C>
+    void draw_span(size_t x, size_t y, size_t length) {
+        if(!clip_row(y)) return;
+        size_t x_start = std::max(x, clip_x_start);
+        size_t x_end = std::min(x + length, clip_x_end);
+        if(x_start >= x_end) return;
+        fill_rect<O, C>(x_start, x_end, y, y + 1);
     }
 
     bool get_pixel(size_t x, size_t y) {
+        flush_clear();
         bool pixel = false;
         if(x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
-            pixel = display_buffer.test(x + y * DISPLAY_WIDTH);
+            pixel = (buffer[y][x / WORD_BITS] >> (x % WORD_BITS)) & 1;
         }
         return pixel;
     }
 
     void set_color(Color _color) {
         color = _color;
+        update_writer();
     }
 
     Color get_color() {
         return color;
     }
 
+    void set_bitmap_mode(bool alpha) {
+        bitmap_transparent = alpha;
+    }
+
     void set_font(const uint8_t* font) {
         this->font = font;
+        font_glyphs = glyph_cache_get_font(font);
+    }
+
+    const uint8_t* get_font() {
+        return font;
     }
 
     void set_font_direction(CanvasDirection direction) {
@@ -76,60 +826,474 @@ public:
         return font_direction;
     }
 
-    static void draw_pixel_fg(uint8_t x, uint8_t y, void* context) {
-        CanvasInstance* canvas = (CanvasInstance*)context;
-        canvas->set_pixel(x, y);
+    const FontMetrics* get_font_metrics() {
+        if(font_metrics->font != font) {
+            font_metrics = font_get_metrics(font);
+        }
+        return font_metrics;
     }
 
-    static void draw_pixel_bg(uint8_t x, uint8_t y, void* context) {
-        CanvasInstance* canvas = (CanvasInstance*)context;
-        canvas->clear_pixel(x, y);
+    // Glyph lookup without touching bitmaps, false if the font has no such glyph
+    bool get_glyph_metrics(uint16_t encoding, GlyphMetrics& metrics) {
+        if(encoding < U8G2_FONT_INDEX_SIZE) {
+            metrics = get_font_metrics()->ascii[encoding];
+            return metrics.present;
+        }
+        const GlyphBitmap* glyph = glyph_cache_get(font_glyphs, encoding);
+        if(glyph == nullptr) return false;
+        metrics = {true, glyph->width, glyph->x_offset, glyph->pitch};
+        return true;
     }
 
+    // Same as u8g2_GetStrWidth: glyph pitches summed, except for the last glyph which counts
+    // with its box width and offset
+    uint16_t get_string_width(const char* text) {
+        int width = 0;
+        int pitch = 0;
+        GlyphMetrics last = {};
+        while(*text) {
+            GlyphMetrics glyph;
+            pitch = 0;
+            if(get_glyph_metrics(U8G2FontRender_NextCodePoint(&text), glyph)) {
+                pitch = glyph.pitch;
+                last = glyph;
+            }
+            width += pitch;
+        }
+        if(last.width) {
+            width += last.width + last.x_offset - pitch;
+        }
+        return width;
+    }
+
+    template <typename O>
     void draw_string(uint16_t x, uint16_t y, const char* text) {
-        U8G2FontRender_t render = U8G2FontRender(this->font, draw_pixel_fg, draw_pixel_bg, this);
-        U8G2FontRender_Print(&render, x, y, text);
+        uint8_t cursor = x;
+        while(*text) {
+            uint16_t encoding = U8G2FontRender_NextCodePoint(&text);
+            const GlyphBitmap* glyph = glyph_cache_get(font_glyphs, encoding);
+            if(glyph == nullptr) continue;
+
+            if(glyph->width && glyph->height) {
+                uint8_t box_x = cursor + glyph->x_offset;
+                uint8_t box_y = y - glyph->height - glyph->y_offset;
+                int glyph_x = wrap_coordinate(box_x, glyph->width);
+                int glyph_y = wrap_coordinate(box_y, glyph->height);
+                // Glyphs outside of the frame are skipped without touching their bitmaps
+                if(!clip_rejects(
+                       glyph_x,
+                       glyph_y,
+                       glyph_x + glyph->width - 1,
+                       glyph_y + glyph->height - 1)) {
+                    draw_glyph<O>(glyph_x, glyph_y, glyph);
+                    count_cost(&CanvasCostCounters::glyphs, 1);
+                    count_cost(&CanvasCostCounters::glyph_bits, glyph->bits);
+                }
+            }
+            cursor += glyph->pitch;
+        }
+    }
+
+    template <typename O>
+    void draw_xbm(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint8_t* bitmap) {
+        if(width == 0 || height == 0) return;
+        draw_bits<O>(
+            wrap_coordinate(x, width),
+            wrap_coordinate(y, height),
+            width,
+            height,
+            (width + 7) / 8,
+            bitmap,
+            bitmap_transparent);
     }
 
+    template <typename O, Color C>
     void draw_vertical_line(uint16_t x, uint16_t y, uint16_t length) {
-        for(uint16_t i = 0; i < length; i++) {
-            set_pixel(x, y + i);
-        }
+        if(!clip_column(x)) return;
+        size_t y_start = std::max<size_t>(y, clip_y_start);
+        size_t y_end = std::min<size_t>(y + length, clip_y_end);
+        if(y_start >= y_end) return;
+        fill_rect<O, C>(x, x + 1, y_start, y_end);
     }
 
+    template <typename O, Color C>
     void draw_horizontal_line(uint16_t x, uint16_t y, uint16_t length) {
-        for(uint16_t i = 0; i < length; i++) {
-            set_pixel(x + i, y);
+        draw_span<O, C>(x, y, length);
+    }
+
+    // u8g2_DrawLine stepping, calls span(x, y, length) for every horizontal run of pixels.
+    // Coordinates are 8 bit and wrap like in u8g2.
+    template <typename Span>
+    static void trace_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, Span span) {
+        int dx = std::abs(x2 - x1);
+        int dy = std::abs(y2 - y1);
+        bool swapxy = dy > dx;
+        if(swapxy) {
+            std::swap(dx, dy);
+            std::swap(x1, y1);
+            std::swap(x2, y2);
+        }
+        if(x1 > x2) {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+        }
+
+        int err = dx >> 1;
+        int ystep = y2 > y1 ? 1 : -1;
+        uint8_t y = y1;
+        // u8g2 stops one pixel short so the 8 bit loop counter can not overflow
+        int x_end = x2 == UINT8_MAX ? x2 - 1 : x2;
+
+        if(swapxy) {
+            // Steep line, a single pixel on each row
+            for(int x = x1; x <= x_end; x++) {
+                span(y, (uint8_t)x, 1);
+                err -= dy;
+                if(err < 0) {
+                    y += ystep;
+                    err += dx;
+                }
+            }
+            return;
+        }
+
+        int run = x1;
+        for(int x = x1; x <= x_end; x++) {
+            err -= dy;
+            if(err < 0) {
+                span(run, y, x - run + 1);
+                y += ystep;
+                err += dx;
+                run = x + 1;
+            }
+        }
+        if(run <= x_end) {
+            span(run, y, x_end - run + 1);
+        }
+    }
+
+    // Runs shorter than this are cheaper to step pixel by pixel than to divide for
+    static constexpr int LINE_RUN_SLICE_MIN = 8;
+
+    // Bresenham steps of a sloped line: err loses d_minor on every pixel along the major axis
+    // and the minor coordinate moves when it drops below zero, getting d_major back. Number of
+    // pixels stepped before the minor coordinate has moved `moves` times.
+    static int line_move_step(int moves, int err, int d_major, int d_minor) {
+        return moves <= 0 ? 0 : ((moves - 1) * d_major + err) / d_minor + 1;
+    }
+
+    // Cuts a sloped display line to the clip once, so it is stepped without per pixel checks.
+    // [major, major_end) and minor are its major axis pixels and first minor coordinate, they
+    // are moved to the part inside the clip along with err. False when nothing is left.
+    template <bool Steep>
+    bool clip_line(
+        size_t& major,
+        size_t& major_end,
+        uint8_t& minor,
+        int& err,
+        int minor_step,
+        int d_major,
+        int d_minor) const {
+        int minor_clip_start = Steep ? clip_x_start : clip_y_start;
+        int minor_clip_end = Steep ? clip_x_end : clip_y_end;
+        // Moves until the minor coordinate enters and leaves the clip
+        int enter = minor_step > 0 ? minor_clip_start - minor : minor - (minor_clip_end - 1);
+        int leave = minor_step > 0 ? minor_clip_end - minor : minor - minor_clip_start + 1;
+        size_t first = std::max({
+            major,
+            Steep ? clip_y_start : clip_x_start,
+            major + line_move_step(enter, err, d_major, d_minor),
+        });
+        size_t last = std::min({
+            major_end,
+            Steep ? clip_y_end : clip_x_end,
+            major + line_move_step(leave, err, d_major, d_minor),
+        });
+        if(first >= last) return false;
+
+        int steps = first - major;
+        int moves = (steps * d_minor - err + d_major - 1) / d_major;
+        err += moves * d_major - steps * d_minor;
+        minor += minor_step * moves;
+        major = first;
+        major_end = last;
+        return true;
+    }
+
+    // 45 degree display line, both coordinates step on every pixel
+    template <Color C>
+    void draw_diagonal_line(size_t x, size_t x_end, uint8_t y, int ystep) {
+        for(; x < x_end; x++, y += ystep) {
+            apply_mask<C>(buffer[y][x / WORD_BITS], 1ULL << (x % WORD_BITS));
+        }
+    }
+
+    // Display line with more columns than rows, clipped to [x, x_end). A Bresenham run at one y
+    // keeps going while err stays non-negative, so long runs are err / dy + 1 pixels and are
+    // drawn as a single mask.
+    template <Color C>
+    void draw_shallow_line(size_t x, size_t x_end, uint8_t y, int ystep, int err, int dx, int dy) {
+        if(dx < dy * LINE_RUN_SLICE_MIN) {
+            // Short runs, pixels of a run are gathered into a word mask as they are stepped
+            uint64_t mask = 0;
+            for(; x < x_end; x++) {
+                mask |= 1ULL << (x % WORD_BITS);
+                err -= dy;
+                if(err < 0 || x % WORD_BITS == WORD_BITS - 1 || x + 1 == x_end) {
+                    apply_mask<C>(buffer[y][x / WORD_BITS], mask);
+                    mask = 0;
+                }
+                if(err < 0) {
+                    y += ystep;
+                    err += dx;
+                }
+            }
+            return;
+        }
+
+        while(x < x_end) {
+            size_t run_end = std::min<size_t>(x + err / dy + 1, x_end);
+            size_t word = x / WORD_BITS;
+            if((run_end - 1) / WORD_BITS == word) {
+                uint64_t mask = word_mask(x % WORD_BITS, run_end - word * WORD_BITS);
+                apply_mask<C>(buffer[y][word], mask);
+            } else {
+                fill_display_rect<C>(x, run_end, y, y + 1);
+            }
+            err -= (int)(run_end - x) * dy - dx;
+            y += ystep;
+            x = run_end;
+        }
+    }
+
+    // Line with more rows than columns, clipped to [y, y_end), long vertical runs are found the
+    // same way
+    template <Color C>
+    void draw_steep_line(size_t y, size_t y_end, uint8_t x, int xstep, int err, int dy, int dx) {
+        if(dy < dx * LINE_RUN_SLICE_MIN) {
+            for(; y < y_end; y++) {
+                apply_mask<C>(buffer[y][x / WORD_BITS], 1ULL << (x % WORD_BITS));
+                err -= dx;
+                if(err < 0) {
+                    x += xstep;
+                    err += dy;
+                }
+            }
+            return;
+        }
+
+        while(y < y_end) {
+            size_t run_end = std::min<size_t>(y + err / dx + 1, y_end);
+            uint64_t mask = 1ULL << (x % WORD_BITS);
+            for(size_t i = y; i < run_end; i++) {
+                apply_mask<C>(buffer[i][x / WORD_BITS], mask);
+            }
+            err -= (int)(run_end - y) * dx - dy;
+            x += xstep;
+            y = run_end;
+        }
+    }
+
+    // Rows of a sloped line in the horizontal orientation, which writes display rows directly
+    void mark_line_rows(uint8_t y1, uint8_t y2) {
+        size_t y_end = std::min<size_t>(std::max(y1, y2) + 1, DISPLAY_HEIGHT);
+        rows_dirty |= row_mask(std::min(y1, y2), y_end);
+    }
+
+    // Widest sloped line taken by draw_short_line
+    static constexpr size_t LINE_SHORT_MAX = 16;
+
+    // Graph segment: sloped, y1 < y2, at most LINE_SHORT_MAX columns wide and inside the
+    // clip. Its few pixels cost less than the setup of the general path, so it is stepped
+    // with none.
+    template <Color C>
+    void draw_short_line(size_t x1, size_t y1, size_t x2, size_t y2, size_t dx) {
+        int dy = y2 - y1;
+        rows_dirty |= row_mask(y1, y2 + 1);
+        if((int)dx >= dy) {
+            // u8g2 steps shallow lines left to right
+            if(x1 > x2) {
+                std::swap(x1, x2);
+                std::swap(y1, y2);
+            }
+            int ystep = y2 > y1 ? 1 : -1;
+            int err = dx >> 1;
+            uint64_t mask = 0;
+            for(size_t x = x1, y = y1; x <= x2; x++) {
+                mask |= 1ULL << (x % WORD_BITS);
+                err -= dy;
+                if(err < 0 || x % WORD_BITS == WORD_BITS - 1 || x == x2) {
+                    apply_mask<C>(buffer[y][x / WORD_BITS], mask);
+                    mask = 0;
+                }
+                if(err < 0) {
+                    y += ystep;
+                    err += dx;
+                }
+            }
+        } else {
+            // Walk the pixel's word down the rows, a column step rotates its bit and moves to
+            // the neighbouring word when the bit wraps
+            int xstep = x2 > x1 ? 1 : -1;
+            uint64_t wrap_bit = x2 > x1 ? 1 : 1ULL << (WORD_BITS - 1);
+            uint64_t* word = &buffer[y1][x1 / WORD_BITS];
+            uint64_t bit = 1ULL << (x1 % WORD_BITS);
+            int err = dy >> 1;
+            for(int rows = dy; rows >= 0; rows--, word += ROW_WORDS) {
+                apply_mask<C>(*word, bit);
+                err -= dx;
+                if(err < 0) {
+                    bit = std::rotl(bit, xstep);
+                    word += bit == wrap_bit ? xstep : 0;
+                    err += dy;
+                }
+            }
+        }
+    }
+
+    // Same pixels as u8g2_DrawLine. Its one pixel short stop at coordinate 255 is always
+    // off screen, so clipping to the display covers it.
+    template <typename O, Color C>
+    void draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+        if constexpr(std::is_same_v<O, CanvasHorizontal>) {
+            // u8g2 steps steep lines top to bottom
+            size_t x_top = y1 < y2 ? x1 : x2;
+            size_t x_bottom = y1 < y2 ? x2 : x1;
+            size_t y_top = std::min(y1, y2);
+            size_t y_bottom = std::max(y1, y2);
+            size_t x_start = std::min(x_top, x_bottom);
+            size_t x_end = std::max(x_top, x_bottom);
+            size_t dx = x_end - x_start;
+            if(dx && dx <= LINE_SHORT_MAX && y_top != y_bottom &&
+               clip_contains(x_start, y_top, x_end, y_bottom)) {
+                draw_short_line<C>(x_top, y_top, x_bottom, y_bottom, dx);
+                return;
+            }
+        }
+        draw_any_line<O, C>(x1, y1, x2, y2);
+    }
+
+    // Everything draw_line does not hand to draw_short_line. Kept out of line so the short
+    // path stays a small leaf.
+    template <typename O, Color C>
+    [[gnu::noinline]] void draw_any_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+        int dx = std::abs(x2 - x1);
+        int dy = std::abs(y2 - y1);
+        if(clip_rejects(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2))) {
+            return;
+        }
+        if(dx == 0 && dy == 0) {
+            set_pixel<O, C>(x1, y1);
+        } else if(dx == 0) {
+            draw_vertical_line<O, C>(x1, std::min(y1, y2), dy + 1);
+        } else if(dy == 0) {
+            draw_span<O, C>(std::min(x1, x2), y1, dx + 1);
+        } else if constexpr(!std::is_same_v<O, CanvasHorizontal>) {
+            // Runs are traced in logical coordinates so mirrored lines keep u8g2 rounding
+            trace_line(x1, y1, x2, y2, [this](uint8_t x, uint8_t y, int length) {
+                draw_span<O, C>(x, y, length);
+            });
+        } else {
+            mark_line_rows(y1, y2);
+            // Lines inside the clip, the usual case, skip cutting
+            bool inside = clip_contains(
+                std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2));
+            if(dx >= dy) {
+                if(x1 > x2) {
+                    std::swap(x1, x2);
+                    std::swap(y1, y2);
+                }
+                size_t x = x1;
+                size_t x_end = x2 + 1;
+                int ystep = y2 > y1 ? 1 : -1;
+                int err = dx >> 1;
+                if(!inside && !clip_line<false>(x, x_end, y1, err, ystep, dx, dy)) return;
+                if(dx == dy) {
+                    draw_diagonal_line<C>(x, x_end, y1, ystep);
+                } else {
+                    draw_shallow_line<C>(x, x_end, y1, ystep, err, dx, dy);
+                }
+            } else {
+                if(y1 > y2) {
+                    std::swap(x1, x2);
+                    std::swap(y1, y2);
+                }
+                size_t y = y1;
+                size_t y_end = y2 + 1;
+                int xstep = x2 > x1 ? 1 : -1;
+                int err = dy >> 1;
+                if(!inside && !clip_line<true>(y, y_end, x1, err, xstep, dy, dx)) return;
+                draw_steep_line<C>(y, y_end, x1, xstep, err, dy, dx);
+            }
+        }
+    }
+
+    // Fills rows between the edges, edges are the same pixels draw_line would draw
+    template <typename O, Color C>
+    void draw_triangle_filled(
+        uint8_t x1,
+        uint8_t y1,
+        uint8_t x2,
+        uint8_t y2,
+        uint8_t x3,
+        uint8_t y3) {
+        int row_start[UINT8_MAX + 1];
+        int row_end[UINT8_MAX + 1];
+        uint8_t y_min = std::min({y1, y2, y3});
+        uint8_t y_max = std::max({y1, y2, y3});
+        for(int y = y_min; y <= y_max; y++) {
+            row_start[y] = UINT8_MAX + 1;
+            row_end[y] = -1;
+        }
+
+        auto extend = [&](uint8_t x, uint8_t y, int length) {
+            if(y < y_min || y > y_max) return;
+            row_start[y] = std::min<int>(row_start[y], x);
+            row_end[y] = std::max<int>(row_end[y], x + length - 1);
+        };
+        trace_line(x1, y1, x2, y2, extend);
+        trace_line(x2, y2, x3, y3, extend);
+        trace_line(x3, y3, x1, y1, extend);
+
+        int y_start = std::max<int>(y_min, clip_y_start);
+        int y_end = std::min<int>(y_max + 1, clip_y_end);
+        for(int y = y_start; y < y_end; y++) {
+            if(row_end[y] >= row_start[y]) {
+                draw_span<O, C>(row_start[y], y, row_end[y] - row_start[y] + 1);
+            }
         }
     }
 
+    template <typename O, Color C>
     void draw_circle_section(uint8_t x, uint8_t y, uint8_t x0, uint8_t y0, uint8_t option) {
         /* upper right */
         if(option & U8G2_DRAW_UPPER_RIGHT) {
-            set_pixel(x0 + x, y0 - y);
-            set_pixel(x0 + y, y0 - x);
+            set_pixel<O, C>(x0 + x, y0 - y);
+            set_pixel<O, C>(x0 + y, y0 - x);
         }
 
         /* upper left */
         if(option & U8G2_DRAW_UPPER_LEFT) {
-            set_pixel(x0 - x, y0 - y);
-            set_pixel(x0 - y, y0 - x);
+            set_pixel<O, C>(x0 - x, y0 - y);
+            set_pixel<O, C>(x0 - y, y0 - x);
         }
 
         /* lower right */
         if(option & U8G2_DRAW_LOWER_RIGHT) {
-            set_pixel(x0 + x, y0 + y);
-            set_pixel(x0 + y, y0 + x);
+            set_pixel<O, C>(x0 + x, y0 + y);
+            set_pixel<O, C>(x0 + y, y0 + x);
         }
 
         /* lower left */
         if(option & U8G2_DRAW_LOWER_LEFT) {
-            set_pixel(x0 - x, y0 + y);
-            set_pixel(x0 - y, y0 + x);
+            set_pixel<O, C>(x0 - x, y0 + y);
+            set_pixel<O, C>(x0 - y, y0 + x);
         }
     }
 
+    template <typename O, Color C>
     void draw_circle(uint8_t x0, uint8_t y0, uint8_t rad, uint8_t option) {
+        if(clip_rejects(x0 - rad, y0 - rad, x0 + rad, y0 + rad)) return;
         int8_t f;
         int8_t ddF_x;
         int8_t ddF_y;
@@ -145,7 +1309,7 @@ public:
         x = 0;
         y = rad;
 
-        draw_circle_section(x, y, x0, y0, option);
+        draw_circle_section<O, C>(x, y, x0, y0, option);
 
         while(x < y) {
             if(f >= 0) {
@@ -157,43 +1321,36 @@ public:
             ddF_x += 2;
             f += ddF_x;
 
-            draw_circle_section(x, y, x0, y0, option);
+            draw_circle_section<O, C>(x, y, x0, y0, option);
         }
     }
 
-    void draw_disc_section(uint8_t x, uint8_t y, uint8_t x0, uint8_t y0, uint8_t option) {
-        /* upper right */
-        if(option & U8G2_DRAW_UPPER_RIGHT) {
-            draw_vertical_line(x0 + x, y0 - y, y + 1);
-            draw_vertical_line(x0 + y, y0 - x, x + 1);
-        }
-
-        /* upper left */
-        if(option & U8G2_DRAW_UPPER_LEFT) {
-            draw_vertical_line(x0 - x, y0 - y, y + 1);
-            draw_vertical_line(x0 - y, y0 - x, x + 1);
-        }
-
-        /* lower right */
-        if(option & U8G2_DRAW_LOWER_RIGHT) {
-            draw_vertical_line(x0 + x, y0, y + 1);
-            draw_vertical_line(x0 + y, y0, x + 1);
-        }
-
-        /* lower left */
-        if(option & U8G2_DRAW_LOWER_LEFT) {
-            draw_vertical_line(x0 - x, y0, y + 1);
-            draw_vertical_line(x0 - y, y0, x + 1);
-        }
+    // Fill pixels [x_start, x_end] of row y, coordinates may be off screen
+    template <typename O, Color C>
+    [[gnu::always_inline]] void fill_row(int x_start, int x_end, int y) {
+        if(y < (int)clip_y_start || y >= (int)clip_y_end) return;
+        x_start = std::max(x_start, (int)clip_x_start);
+        x_end = std::min(x_end, (int)clip_x_end - 1);
+        if(x_start > x_end) return;
+        fill_rect<O, C>(x_start, x_end + 1, y, y + 1);
     }
 
-    void draw_disc(uint8_t x0, uint8_t y0, uint8_t rad, uint8_t option) {
+    // Half width of each disc row: row d above or below the center spans x0 - w to x0 + w.
+    // Same pixels as the u8g2 octant fill, which covers column x down to row y and column y
+    // down to row x on every midpoint step.
+    static void disc_half_widths(uint8_t rad, uint8_t* half_width) {
         int8_t f;
         int8_t ddF_x;
         int8_t ddF_y;
         uint8_t x;
         uint8_t y;
 
+        memset(half_width, 0, rad + 1);
+        auto cover = [half_width](uint8_t x, uint8_t y) {
+            half_width[y] = std::max(half_width[y], x);
+            half_width[x] = std::max(half_width[x], y);
+        };
+
         f = 1;
         f -= rad;
         ddF_x = 1;
@@ -203,7 +1360,7 @@ public:
         x = 0;
         y = rad;
 
-        draw_disc_section(x, y, x0, y0, option);
+        cover(x, y);
 
         while(x < y) {
             if(f >= 0) {
@@ -215,44 +1372,394 @@ public:
             ddF_x += 2;
             f += ddF_x;
 
-            draw_disc_section(x, y, x0, y0, option);
+            cover(x, y);
+        }
+
+        // A column reaching row d also covers all rows closer to the center
+        for(int d = rad - 1; d >= 0; d--) {
+            half_width[d] = std::max(half_width[d], half_width[d + 1]);
+        }
+    }
+
+    template <typename O, Color C>
+    void draw_disc(uint8_t x0, uint8_t y0, uint8_t rad, uint8_t option) {
+        if(clip_rejects(x0 - rad, y0 - rad, x0 + rad, y0 + rad)) return;
+        uint8_t half_width[UINT8_MAX + 1];
+        disc_half_widths(rad, half_width);
+
+        bool upper_left = option & U8G2_DRAW_UPPER_LEFT;
+        bool upper_right = option & U8G2_DRAW_UPPER_RIGHT;
+        bool lower_left = option & U8G2_DRAW_LOWER_LEFT;
+        bool lower_right = option & U8G2_DRAW_LOWER_RIGHT;
+
+        // Center row belongs to all quadrants, every row is filled once
+        for(int d = 0; d <= rad; d++) {
+            int width = half_width[d];
+            bool left[2] = {upper_left || (d == 0 && lower_left), lower_left};
+            bool right[2] = {upper_right || (d == 0 && lower_right), lower_right};
+            int rows[2] = {y0 - d, y0 + d};
+            for(size_t i = 0; i < (d == 0 ? 1 : 2); i++) {
+                if(left[i] || right[i]) {
+                    fill_row<O, C>(left[i] ? x0 - width : x0, right[i] ? x0 + width : x0, rows[i]);
+                }
+            }
+        }
+    }
+
+    // u8g2_DrawRBox shape: disc quadrants centered radius pixels in from each corner, joined
+    // by boxes. Each row is filled as one span covering the corners and boxes on it.
+    template <typename O, Color C>
+    void draw_rounded_box(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius) {
+        if(width == 0 || height == 0) return;
+        if(clip_rejects(x, y, x + width - 1, y + height - 1)) return;
+
+        uint8_t half_width[UINT8_MAX + 1];
+        disc_half_widths(radius, half_width);
+
+        int x_left = x + radius;
+        int x_right = x + width - radius - 1;
+        int y_upper = y + radius;
+        int y_lower = y + height - radius - 1;
+        int y_start = std::max<int>(y, clip_y_start);
+        int y_end = std::min<int>(y + height, clip_y_end);
+
+        for(int row = y_start; row < y_end; row++) {
+            int span_start = x + width;
+            int span_end = x - 1;
+            auto corner = [&](int d) {
+                if(d < 0 || d > radius) return;
+                // Left and right quadrants overlap when the corners are closer than the radius
+                span_start = std::min({span_start, x_left - half_width[d], x_right});
+                span_end = std::max({span_end, x_right + half_width[d], x_left});
+            };
+            corner(y_upper - row);
+            corner(row - y_lower);
+            if(row > y_upper && row < y_lower) {
+                span_start = x;
+                span_end = x + width - 1;
+            }
+            if(span_start <= span_end) {
+                fill_row<O, C>(span_start, span_end, row);
+            }
+        }
+    }
+
+    template <typename O, Color C>
+    void draw_box(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        size_t x_start = std::max<size_t>(x, clip_x_start);
+        size_t y_start = std::max<size_t>(y, clip_y_start);
+        size_t x_end = std::min<size_t>(x + width, clip_x_end);
+        size_t y_end = std::min<size_t>(y + height, clip_y_end);
+        if(x_start >= x_end || y_start >= y_end) return;
+        fill_rect<O, C>(x_start, x_end, y_start, y_end);
+    }
+
+    // Edges as in u8g2_DrawFrame, they do not overlap so XOR frames keep their corners
+    template <typename O, Color C>
+    void draw_frame(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        draw_horizontal_line<O, C>(x, y, width);
+        if(height < 2) return;
+        draw_vertical_line<O, C>(x, y + 1, height - 2);
+        draw_vertical_line<O, C>(x + width - 1, y + 1, height - 2);
+        draw_horizontal_line<O, C>(x, y + height - 1, width);
+    }
+
+    // Clip to the frame, coordinates are logical ones of the current orientation
+    void set_clip(size_t x, size_t y, size_t width, size_t height) {
+        clip_x_start = std::min(x, canvas_width);
+        clip_y_start = std::min(y, canvas_height);
+        clip_x_end = std::min(x + width, canvas_width);
+        clip_y_end = std::min(y + height, canvas_height);
+        update_clip_mask();
+    }
+
+    void set_orientation(CanvasOrientation orientation) {
+        this->orientation = orientation;
+        bool vertical = orientation == CanvasOrientationVertical ||
+                        orientation == CanvasOrientationVerticalFlip;
+        canvas_width = vertical ? DISPLAY_HEIGHT : DISPLAY_WIDTH;
+        canvas_height = vertical ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+        update_writer();
+    }
+
+    void update_writer() {
+        switch(orientation) {
+        case CanvasOrientationHorizontal:
+            writer = get_writer<CanvasHorizontal>(color);
+            break;
+        case CanvasOrientationHorizontalFlip:
+            writer = get_writer<CanvasHorizontalFlip>(color);
+            break;
+        case CanvasOrientationVertical:
+            writer = get_writer<CanvasVertical>(color);
+            break;
+        case CanvasOrientationVerticalFlip:
+            writer = get_writer<CanvasVerticalFlip>(color);
+            break;
+        default:
+            abort();
+        }
+    }
+
+    void draw_string(uint8_t x, uint8_t y, const char* text) {
+        if(display_list_enabled) {
+            record(CommandType::String, {x, y}, text, strlen(text) + 1);
+            return;
+        }
+        count_command(CommandType::String);
+        begin_command(CommandType::String);
+        (this->*writer->draw_string)(x, y, text);
+    }
+
+    void draw_xbm(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint8_t* bitmap) {
+        if(display_list_enabled) {
+            record(CommandType::Xbm, {x, y, width, height}, bitmap, (width + 7) / 8 * height);
+            return;
+        }
+        count_command(CommandType::Xbm);
+        begin_command(CommandType::Xbm);
+        (this->*writer->draw_xbm)(x, y, width, height, bitmap);
+    }
+
+    void draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+        if(display_list_enabled) {
+            record(CommandType::Line, {x1, y1, x2, y2});
+            return;
+        }
+        count_command(CommandType::Line);
+        begin_command(CommandType::Line);
+        (this->*writer->draw_line)(x1, y1, x2, y2);
+    }
+
+    void draw_triangle_filled(
+        uint8_t x1,
+        uint8_t y1,
+        uint8_t x2,
+        uint8_t y2,
+        uint8_t x3,
+        uint8_t y3) {
+        if(display_list_enabled) {
+            record(CommandType::TriangleFilled, {x1, y1, x2, y2, x3, y3});
+            return;
+        }
+        count_command(CommandType::TriangleFilled);
+        begin_command(CommandType::TriangleFilled);
+        (this->*writer->draw_triangle_filled)(x1, y1, x2, y2, x3, y3);
+    }
+
+    void draw_circle(uint8_t x0, uint8_t y0, uint8_t rad, uint8_t option) {
+        if(display_list_enabled) {
+            record(CommandType::Circle, {x0, y0, rad, option});
+            return;
         }
+        count_command(CommandType::Circle);
+        begin_command(CommandType::Circle);
+        (this->*writer->draw_circle)(x0, y0, rad, option);
+    }
+
+    void draw_disc(uint8_t x0, uint8_t y0, uint8_t rad, uint8_t option) {
+        if(display_list_enabled) {
+            record(CommandType::Disc, {x0, y0, rad, option});
+            return;
+        }
+        count_command(CommandType::Disc);
+        begin_command(CommandType::Disc);
+        (this->*writer->draw_disc)(x0, y0, rad, option);
     }
 
     void draw_box(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
-        for(uint8_t i = 0; i < height; i++) {
-            draw_horizontal_line(x, y + i, width);
+        if(display_list_enabled) {
+            record(CommandType::Box, {x, y, width, height});
+            return;
         }
+        count_command(CommandType::Box);
+        begin_command(CommandType::Box);
+        (this->*writer->draw_box)(x, y, width, height);
     }
 
     void draw_frame(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
-        draw_vertical_line(x, y, height);
-        draw_vertical_line(x + width - 1, y, height);
-        draw_horizontal_line(x, y, width);
-        draw_horizontal_line(x, y + height - 1, width);
+        if(display_list_enabled) {
+            record(CommandType::Frame, {x, y, width, height});
+            return;
+        }
+        count_command(CommandType::Frame);
+        begin_command(CommandType::Frame);
+        (this->*writer->draw_frame)(x, y, width, height);
+    }
+
+    void draw_rounded_box(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius) {
+        if(display_list_enabled) {
+            record(CommandType::RoundedBox, {x, y, width, height, radius});
+            return;
+        }
+        count_command(CommandType::RoundedBox);
+        begin_command(CommandType::RoundedBox);
+        (this->*writer->draw_rounded_box)(x, y, width, height, radius);
+    }
+
+    void draw_rounded_frame(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius) {
+        if(display_list_enabled) {
+            record(CommandType::RoundedFrame, {x, y, width, height, radius});
+            return;
+        }
+        count_command(CommandType::RoundedFrame);
+        begin_command(CommandType::RoundedFrame);
+        (this->*writer->draw_rounded_frame)(x, y, width, height, radius);
+    }
+
+    void set_display_list(bool enable) {
+        if(display_list_enabled && !enable) {
+            replay_display_list();
+        }
+        display_list_enabled = enable;
+        display_list_hash_valid = false;
+    }
+
+    const CanvasDisplayListStats& get_display_list_stats() {
+        return display_list_stats;
+    }
+
+    uint8_t* get_pages() {
+        // Pending commands belong to the frame being drawn
+        if(display_list_enabled && !display_list.empty()) {
+            replay_display_list();
+            display_list_hash_valid = false;
+        }
+        flush_clear();
+        if(pages_valid) return &pages[0][0];
+
+        // 8x8 blocks of 8 rows by 8 columns transpose into 8 page bytes
+        for(size_t page = 0; page < DISPLAY_HEIGHT / 8; page++) {
+            for(size_t x = 0; x < DISPLAY_WIDTH; x += 8) {
+                uint64_t block = 0;
+                for(size_t i = 0; i < 8; i++) {
+                    uint64_t row = buffer[page * 8 + i][x / WORD_BITS] >> (x % WORD_BITS);
+                    block |= (row & 0xFF) << (i * 8);
+                }
+                block = transpose_block(block);
+                for(size_t i = 0; i < 8; i++) {
+                    pages[page][x + i] = block >> (i * 8);
+                }
+            }
+        }
+        pages_valid = true;
+        return &pages[0][0];
+    }
+
+    // Rasterizes the recorded frame. Returns false when it can be skipped: it starts with a full
+    // fill and hashes the same as the last drawn frame, so the framebuffer already holds it.
+    bool render_display_list() {
+        if(!display_list_enabled) return true;
+
+        uint64_t hash = hash_display_list();
+        bool whole_frame = !display_list.empty() && display_list[0].type == CommandType::Fill;
+        bool skip = whole_frame && display_list_hash_valid && hash == display_list_hash;
+
+        display_list_stats.frames++;
+        if(skip) {
+            display_list_stats.frames_skipped++;
+            display_list.clear();
+            display_list_data.clear();
+        } else {
+            replay_display_list();
+        }
+
+        display_list_hash = hash;
+        display_list_hash_valid = whole_frame;
+        return !skip;
+    }
+
+    // Settles pending rows and closes the clear counters of the frame
+    void end_frame() {
+        flush_clear();
+        clear_stats.frame = clear_counters;
+        clear_stats.total.clears += clear_counters.clears;
+        clear_stats.total.rows_cleared += clear_counters.rows_cleared;
+        clear_stats.total.rows_covered += clear_counters.rows_covered;
+        clear_stats.total.rows_clean += clear_counters.rows_clean;
+        clear_counters = {};
+    }
+
+    const CanvasClearStats& get_clear_stats() {
+        return clear_stats;
+    }
+
+    const CanvasCostCounters& get_cost_counters() {
+        return cost_counters;
+    }
+
+    DisplayRegion get_dirty_region() {
+        flush_clear();
+        if(!committed_valid) {
+            return {0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT};
+        }
+
+        // Bounding box of bits that differ from the committed frame
+        size_t x_min = DISPLAY_WIDTH;
+        size_t x_max = 0;
+        size_t y_min = DISPLAY_HEIGHT;
+        size_t y_max = 0;
+        for(size_t y = 0; y < DISPLAY_HEIGHT; y++) {
+            for(size_t i = 0; i < ROW_WORDS; i++) {
+                uint64_t diff = buffer[y][i] ^ committed[y][i];
+                if(diff == 0) continue;
+                x_min = std::min(x_min, i * WORD_BITS + std::countr_zero(diff));
+                x_max = std::max(x_max, i * WORD_BITS + WORD_BITS - 1 - std::countl_zero(diff));
+                y_min = std::min(y_min, y);
+                y_max = y;
+            }
+        }
+
+        if(y_min == DISPLAY_HEIGHT) {
+            return {0, 0, 0, 0};
+        }
+        return {x_min, y_min, x_max - x_min + 1, y_max - y_min + 1};
+    }
+
+    void copy_to(DisplayFrame* frame) {
+        static_assert(sizeof(frame->rows) == sizeof(buffer), "Display frame layout mismatch");
+        flush_clear();
+        memcpy(frame->rows, buffer, sizeof(buffer));
     }
 
+    void mark_committed() {
+        flush_clear();
+        memcpy(committed, buffer, sizeof(buffer));
+        committed_valid = true;
+    }
+
+    template <typename O, Color C>
     void draw_rounded_frame(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius) {
-        draw_horizontal_line(x + radius, y, width - 2 * radius);
-        draw_horizontal_line(x + radius, y + height - 1, width - 2 * radius);
-        draw_vertical_line(x, y + radius, height - 2 * radius);
-        draw_vertical_line(x + width - 1, y + radius, height - 2 * radius);
-        draw_circle(x + radius + 1, y + radius, radius, U8G2_DRAW_UPPER_RIGHT);
-        draw_circle(x + width - radius - 2, y + radius, radius, U8G2_DRAW_UPPER_LEFT);
-        draw_circle(x + radius + 1, y + height - radius - 1, radius, U8G2_DRAW_LOWER_RIGHT);
-        draw_circle(x + width - radius - 2, y + height - radius - 1, radius, U8G2_DRAW_LOWER_LEFT);
+        draw_horizontal_line<O, C>(x + radius, y, width - 2 * radius);
+        draw_horizontal_line<O, C>(x + radius, y + height - 1, width - 2 * radius);
+        draw_vertical_line<O, C>(x, y + radius, height - 2 * radius);
+        draw_vertical_line<O, C>(x + width - 1, y + radius, height - 2 * radius);
+        draw_circle<O, C>(x + radius + 1, y + radius, radius, U8G2_DRAW_UPPER_RIGHT);
+        draw_circle<O, C>(x + width - radius - 2, y + radius, radius, U8G2_DRAW_UPPER_LEFT);
+        draw_circle<O, C>(x + radius + 1, y + height - radius - 1, radius, U8G2_DRAW_LOWER_RIGHT);
+        draw_circle<O, C>(
+            x + width - radius - 2, y + height - radius - 1, radius, U8G2_DRAW_LOWER_LEFT);
     }
 };
 
 Canvas* canvas_init() {
     Canvas* canvas = new Canvas;
     canvas->orientation = CanvasOrientationHorizontal;
+    canvas->offset_x = 0;
+    canvas->offset_y = 0;
+    canvas->width = DISPLAY_WIDTH;
+    canvas->height = DISPLAY_HEIGHT;
     canvas->fb = new CanvasInstance(canvas);
 
     // Clear buffer and send to device
     canvas_clear(canvas);
     canvas_commit(canvas);
 
+    // The cost model needs pixels written while the view port that draws them is measured
+#if defined(CANVAS_DISPLAY_LIST) && !defined(CANVAS_COST_MODEL)
+    canvas_set_display_list(canvas, true);
+#endif
+
     return canvas;
 }
 
@@ -267,14 +1774,18 @@ void canvas_clear(Canvas* canvas) {
 
 void canvas_commit(Canvas* canvas) {
     CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
-    DisplayBuffer* display_buffer = get_display_buffer();
-
-    for(size_t x = 0; x < DISPLAY_WIDTH; x++) {
-        for(size_t y = 0; y < DISPLAY_HEIGHT; y++) {
-            display_buffer->set_pixel(x, y, canvas_instance->get_pixel(x, y));
-        }
+    bool rendered = canvas_instance->render_display_list();
+    canvas_instance->end_frame();
+    if(!rendered) {
+        // u8g2 still sends a skipped frame, so commit it with nothing changed
+        commit_display_buffer(false, DisplayRegion{});
+        return;
     }
-    commit_display_buffer(true);
+
+    DisplayRegion region = canvas_instance->get_dirty_region();
+    canvas_instance->copy_to(get_display_buffer());
+    canvas_instance->mark_committed();
+    commit_display_buffer(region.width != 0, region);
 }
 
 void canvas_set_font(Canvas* canvas, Font font) {
@@ -301,6 +1812,79 @@ void canvas_draw_str(Canvas* canvas, uint8_t x, uint8_t y, const char* str) {
     canvas_instance->draw_string(x, y, str);
 }
 
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    if(!str) return;
+    x += canvas->offset_x;
+    y += canvas->offset_y;
+
+    switch(horizontal) {
+    case AlignLeft:
+        break;
+    case AlignRight:
+        x -= canvas_instance->get_string_width(str);
+        break;
+    case AlignCenter:
+        x -= canvas_instance->get_string_width(str) / 2;
+        break;
+    default:
+        abort();
+    }
+
+    int8_t ascent = canvas_instance->get_font_metrics()->ascent_A;
+    switch(vertical) {
+    case AlignTop:
+        y += ascent;
+        break;
+    case AlignBottom:
+        break;
+    case AlignCenter:
+        y += ascent / 2;
+        break;
+    default:
+        abort();
+    }
+
+    canvas_instance->draw_string(x, y, str);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    if(!str) return 0;
+    return canvas_instance->get_string_width(str);
+}
+
+uint8_t canvas_glyph_width(Canvas* canvas, char symbol) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    GlyphMetrics glyph;
+    if(!canvas_instance->get_glyph_metrics((uint8_t)symbol, glyph)) return 0;
+    return glyph.pitch;
+}
+
+uint8_t canvas_current_font_height(Canvas* canvas) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    uint8_t font_height = canvas_instance->get_font_metrics()->max_char_height;
+    // Same correction as the firmware, haxrcorp glyphs touch the line below
+    if(canvas_instance->get_font_metrics()->font == u8g2_font_haxrcorp4089_tr) {
+        font_height += 1;
+    }
+    return font_height;
+}
+
+uint8_t canvas_width(Canvas* canvas) {
+    return canvas->width;
+}
+
+uint8_t canvas_height(Canvas* canvas) {
+    return canvas->height;
+}
+
 void canvas_draw_circle(Canvas* canvas, uint8_t x, uint8_t y, uint8_t radius) {
     CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
     x += canvas->offset_x;
@@ -315,8 +1899,54 @@ void canvas_draw_disc(Canvas* canvas, uint8_t x, uint8_t y, uint8_t radius) {
     canvas_instance->draw_disc(x, y, radius, U8G2_DRAW_ALL);
 }
 
+void canvas_set_display_list(Canvas* canvas, bool enable) {
+    static_cast<CanvasInstance*>(canvas->fb)->set_display_list(enable);
+}
+
+CanvasDisplayListStats canvas_get_display_list_stats(const Canvas* canvas) {
+    return static_cast<CanvasInstance*>(canvas->fb)->get_display_list_stats();
+}
+
+CanvasClearStats canvas_get_clear_stats(const Canvas* canvas) {
+    return static_cast<CanvasInstance*>(canvas->fb)->get_clear_stats();
+}
+
+CanvasCostCounters canvas_get_cost_counters(const Canvas* canvas) {
+    return static_cast<CanvasInstance*>(canvas->fb)->get_cost_counters();
+}
+
 void canvas_set_orientation(Canvas* canvas, CanvasOrientation orientation) {
-    // TODO: Implement
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    if(canvas->orientation == orientation) return;
+
+    // Vertical orientations swap the frame sides, like the firmware does
+    bool was_vertical = canvas->orientation == CanvasOrientationVertical ||
+                        canvas->orientation == CanvasOrientationVerticalFlip;
+    bool is_vertical = orientation == CanvasOrientationVertical ||
+                       orientation == CanvasOrientationVerticalFlip;
+    if(was_vertical != is_vertical) {
+        std::swap(canvas->width, canvas->height);
+    }
+
+    canvas_instance->set_orientation(orientation);
+    canvas_instance->set_clip(canvas->offset_x, canvas->offset_y, canvas->width, canvas->height);
+    canvas->orientation = orientation;
+}
+
+CanvasOrientation canvas_get_orientation(const Canvas* canvas) {
+    return canvas->orientation;
+}
+
+const uint8_t* canvas_get_font(const Canvas* canvas) {
+    return static_cast<CanvasInstance*>(canvas->fb)->get_font();
+}
+
+uint8_t* canvas_get_buffer(Canvas* canvas) {
+    return static_cast<CanvasInstance*>(canvas->fb)->get_pages();
+}
+
+size_t canvas_get_buffer_size(Canvas* canvas) {
+    return DISPLAY_WIDTH * DISPLAY_HEIGHT / 8;
 }
 
 void canvas_frame_set(
@@ -325,10 +1955,12 @@ void canvas_frame_set(
     uint8_t offset_y,
     uint8_t width,
     uint8_t height) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
     canvas->offset_x = offset_x;
     canvas->offset_y = offset_y;
     canvas->width = width;
     canvas->height = height;
+    canvas_instance->set_clip(offset_x, offset_y, width, height);
 }
 
 void canvas_reset(Canvas* canvas) {
@@ -343,6 +1975,13 @@ void canvas_set_color(Canvas* canvas, Color color) {
     canvas_instance->set_color(color);
 }
 
+void canvas_invert_color(Canvas* canvas) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    // Same as u8g2 draw_color = !draw_color, so XOR turns into white
+    Color color = canvas_instance->get_color();
+    canvas_instance->set_color(color == ColorWhite ? ColorBlack : ColorWhite);
+}
+
 void canvas_set_font_direction(Canvas* canvas, CanvasDirection dir) {
     CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
     canvas_instance->set_font_direction(dir);
@@ -355,6 +1994,13 @@ void canvas_draw_box(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_
     canvas_instance->draw_box(x, y, width, height);
 }
 
+void canvas_draw_dot(Canvas* canvas, uint8_t x, uint8_t y) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    x += canvas->offset_x;
+    y += canvas->offset_y;
+    canvas_instance->draw_box(x, y, 1, 1);
+}
+
 void canvas_draw_frame(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
     CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
     x += canvas->offset_x;
@@ -373,4 +2019,139 @@ void canvas_draw_rframe(
     x += canvas->offset_x;
     y += canvas->offset_y;
     canvas_instance->draw_rounded_frame(x, y, width, height, radius);
+}
+
+void canvas_draw_xbm(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t w,
+    uint8_t h,
+    const uint8_t* bitmap) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    x += canvas->offset_x;
+    y += canvas->offset_y;
+    canvas_instance->draw_xbm(x, y, w, h, bitmap);
+}
+
+void canvas_draw_bitmap(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    const uint8_t* compressed_bitmap_data) {
+    // First byte tells if the rest is heatshrink compressed, otherwise it is plain XBM
+    if(compressed_bitmap_data[0] == 0) {
+        canvas_draw_xbm(canvas, x, y, width, height, compressed_bitmap_data + 1);
+        return;
+    }
+    std::shared_ptr<const uint8_t[]> bitmap =
+        icon_cache_get(compressed_bitmap_data, width, height);
+    canvas_draw_xbm(canvas, x, y, width, height, bitmap.get());
+}
+
+void canvas_draw_icon_animation(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    IconAnimation* icon_animation) {
+    canvas_draw_bitmap(
+        canvas,
+        x,
+        y,
+        icon_animation_get_width(icon_animation),
+        icon_animation_get_height(icon_animation),
+        icon_animation_get_data(icon_animation));
+}
+
+void canvas_draw_icon(Canvas* canvas, uint8_t x, uint8_t y, const Icon* icon) {
+    canvas_draw_bitmap(
+        canvas, x, y, icon_get_width(icon), icon_get_height(icon), icon_get_data(icon));
+}
+
+void canvas_set_bitmap_mode(Canvas* canvas, bool alpha) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    canvas_instance->set_bitmap_mode(alpha);
+}
+
+void canvas_draw_line(Canvas* canvas, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    x1 += canvas->offset_x;
+    y1 += canvas->offset_y;
+    x2 += canvas->offset_x;
+    y2 += canvas->offset_y;
+    canvas_instance->draw_line(x1, y1, x2, y2);
+}
+
+// Corners of the triangle canvas_draw_triangle outlines: two base ends and the apex
+static void canvas_triangle_corners(
+    uint8_t x,
+    uint8_t y,
+    uint8_t base,
+    uint8_t height,
+    CanvasDirection dir,
+    uint8_t corners[3][2]) {
+    uint8_t half = base / 2;
+    uint8_t apex = height - 1;
+    if(dir == CanvasDirectionBottomToTop || dir == CanvasDirectionTopToBottom) {
+        corners[0][0] = x - half;
+        corners[0][1] = y;
+        corners[1][0] = x + half;
+        corners[1][1] = y;
+        corners[2][0] = x;
+        corners[2][1] = dir == CanvasDirectionBottomToTop ? y - apex : y + apex;
+    } else {
+        corners[0][0] = x;
+        corners[0][1] = y - half;
+        corners[1][0] = x;
+        corners[1][1] = y + half;
+        corners[2][0] = dir == CanvasDirectionRightToLeft ? x - apex : x + apex;
+        corners[2][1] = y;
+    }
+}
+
+void canvas_draw_triangle(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t base,
+    uint8_t height,
+    CanvasDirection dir) {
+    uint8_t corners[3][2];
+    canvas_triangle_corners(x, y, base, height, dir, corners);
+    canvas_draw_line(canvas, corners[0][0], corners[0][1], corners[1][0], corners[1][1]);
+    canvas_draw_line(canvas, corners[0][0], corners[0][1], corners[2][0], corners[2][1]);
+    canvas_draw_line(canvas, corners[2][0], corners[2][1], corners[1][0], corners[1][1]);
+}
+
+void canvas_draw_triangle_filled(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t base,
+    uint8_t height,
+    CanvasDirection dir) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    uint8_t corners[3][2];
+    canvas_triangle_corners(x, y, base, height, dir, corners);
+    for(auto& corner : corners) {
+        corner[0] += canvas->offset_x;
+        corner[1] += canvas->offset_y;
+    }
+    canvas_instance->draw_triangle_filled(
+        corners[0][0], corners[0][1], corners[1][0], corners[1][1], corners[2][0], corners[2][1]);
+}
+
+void canvas_draw_rbox(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    uint8_t radius) {
+    CanvasInstance* canvas_instance = static_cast<CanvasInstance*>(canvas->fb);
+    x += canvas->offset_x;
+    y += canvas->offset_y;
+    canvas_instance->draw_rounded_box(x, y, width, height, radius);
 }
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "canvas_cost.h"
+#include <furi.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "CanvasCost"
+
+static constexpr CanvasCostTable canvas_cost_default_table = {
+    .cpu_hz = 64000000,
+    .frame_budget_us = 16667,
+    .primitive = 150,
+    .pixel = 10,
+    .glyph = 200,
+    .glyph_bit = 15,
+    .clear = 600,
+};
+
+static const struct {
+    const char* name;
+    uint32_t CanvasCostTable::*field;
+} canvas_cost_table_fields[] = {
+    {"cpu_hz", &CanvasCostTable::cpu_hz},
+    {"frame_budget_us", &CanvasCostTable::frame_budget_us},
+    {"primitive", &CanvasCostTable::primitive},
+    {"pixel", &CanvasCostTable::pixel},
+    {"glyph", &CanvasCostTable::glyph},
+    {"glyph_bit", &CanvasCostTable::glyph_bit},
+    {"clear", &CanvasCostTable::clear},
+};
+
+static CanvasCostCounters canvas_cost_difference(
+    const CanvasCostCounters& end,
+    const CanvasCostCounters& start) {
+    return {
+        end.primitives - start.primitives,
+        end.pixels - start.pixels,
+        end.glyphs - start.glyphs,
+        end.glyph_bits - start.glyph_bits,
+        end.clears - start.clears,
+    };
+}
+
+static void canvas_cost_add(CanvasCostCounters& sum, const CanvasCostCounters& counters) {
+    sum.primitives += counters.primitives;
+    sum.pixels += counters.pixels;
+    sum.glyphs += counters.glyphs;
+    sum.glyph_bits += counters.glyph_bits;
+    sum.clears += counters.clears;
+}
+
+class CanvasCost {
+private:
+    static constexpr auto LOG_INTERVAL = std::chrono::seconds(1);
+
+    struct ViewPortCost {
+        const void* draw_callback;
+        uint64_t frames;
+        uint64_t frames_over_budget;
+        uint64_t cycles;
+        uint64_t cycles_max;
+        CanvasCostCounters counters;
+        // Since the last log line
+        uint64_t log_frames;
+        uint64_t log_cycles;
+        uint64_t log_cycles_max;
+    };
+
+    std::mutex mutex;
+    CanvasCostTable table = canvas_cost_default_table;
+    bool started = false;
+    CanvasCostCounters start = {};
+    std::map<const void*, ViewPortCost> view_ports;
+    std::chrono::steady_clock::time_point log_time;
+
+    // Reads the table override and registers the exit report, on first use
+    void init() {
+        if(started) return;
+        started = true;
+        log_time = std::chrono::steady_clock::now();
+        atexit([]() {
+            const char* path = getenv("FAPULATOR_COST_REPORT");
+            canvas_cost_export(path ? path : "canvas_cost.json");
+        });
+
+        const char* path = getenv("FAPULATOR_COST_TABLE");
+        if(path == nullptr) return;
+        FILE* file = fopen(path, "r");
+        if(file == nullptr) {
+            FURI_LOG_E(TAG, "Can't open cycle table %s", path);
+            return;
+        }
+        char name[64];
+        unsigned long value;
+        while(fscanf(file, "%63s %lu", name, &value) == 2) {
+            bool known = false;
+            for(const auto& field : canvas_cost_table_fields) {
+                if(!strcmp(field.name, name)) {
+                    table.*field.field = value;
+                    known = true;
+                }
+            }
+            if(!known) FURI_LOG_W(TAG, "Unknown cycle table entry %s", name);
+        }
+        fclose(file);
+    }
+
+    uint64_t cycles(const CanvasCostCounters& counters) {
+        return (uint64_t)counters.primitives * table.primitive +
+               (uint64_t)counters.pixels * table.pixel +
+               (uint64_t)counters.glyphs * table.glyph +
+               (uint64_t)counters.glyph_bits * table.glyph_bit +
+               (uint64_t)counters.clears * table.clear;
+    }
+
+    uint64_t microseconds(uint64_t cycles) {
+        return table.cpu_hz ? cycles * 1000000 / table.cpu_hz : 0;
+    }
+
+    void log(const void* view_port, ViewPortCost& cost) {
+        FURI_LOG_I(
+            TAG,
+            "ViewPort %p: %llu us per frame on device, max %llu us, %llu of %llu frames over "
+            "%lu us",
+            view_port,
+            (unsigned long long)microseconds(cost.log_cycles / cost.log_frames),
+            (unsigned long long)microseconds(cost.log_cycles_max),
+            (unsigned long long)cost.frames_over_budget,
+            (unsigned long long)cost.frames,
+            (unsigned long)table.frame_budget_us);
+        cost.log_frames = 0;
+        cost.log_cycles = 0;
+        cost.log_cycles_max = 0;
+    }
+
+public:
+    void get_table(CanvasCostTable* table) {
+        std::lock_guard<std::mutex> lock(mutex);
+        init();
+        *table = this->table;
+    }
+
+    void set_table(const CanvasCostTable* table) {
+        std::lock_guard<std::mutex> lock(mutex);
+        init();
+        this->table = *table;
+    }
+
+    uint64_t get_cycles(const CanvasCostCounters* counters) {
+        std::lock_guard<std::mutex> lock(mutex);
+        init();
+        return cycles(*counters);
+    }
+
+    void view_port_begin(Canvas* canvas) {
+        std::lock_guard<std::mutex> lock(mutex);
+        init();
+        start = canvas_get_cost_counters(canvas);
+    }
+
+    void view_port_end(Canvas* canvas, const void* view_port, const void* draw_callback) {
+        std::lock_guard<std::mutex> lock(mutex);
+        CanvasCostCounters counters =
+            canvas_cost_difference(canvas_get_cost_counters(canvas), start);
+        uint64_t frame_cycles = cycles(counters);
+
+        ViewPortCost& cost = view_ports[view_port];
+        cost.draw_callback = draw_callback;
+        cost.frames++;
+        cost.cycles += frame_cycles;
+        cost.cycles_max = std::max(cost.cycles_max, frame_cycles);
+        if(microseconds(frame_cycles) > table.frame_budget_us) {
+            cost.frames_over_budget++;
+        }
+        canvas_cost_add(cost.counters, counters);
+        cost.log_frames++;
+        cost.log_cycles += frame_cycles;
+        cost.log_cycles_max = std::max(cost.log_cycles_max, frame_cycles);
+
+        auto now = std::chrono::steady_clock::now();
+        if(now - log_time >= LOG_INTERVAL) {
+            log_time = now;
+            for(auto& [port, port_cost] : view_ports) {
+                if(port_cost.log_frames) log(port, port_cost);
+            }
+        }
+    }
+
+    bool write_report(const char* path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        FILE* file = fopen(path, "w");
+        if(file == nullptr) return false;
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"table\": {");
+        for(size_t i = 0; i < std::size(canvas_cost_table_fields); i++) {
+            fprintf(
+                file,
+                "%s\"%s\": %lu",
+                i ? ", " : "",
+                canvas_cost_table_fields[i].name,
+                (unsigned long)(table.*canvas_cost_table_fields[i].field));
+        }
+        fprintf(file, "},\n");
+        fprintf(file, "  \"view_ports\": [");
+        size_t index = 0;
+        for(const auto& [view_port, cost] : view_ports) {
+            fprintf(file, "%s\n    {\n", index++ ? "," : "");
+            fprintf(file, "      \"view_port\": \"%p\",\n", view_port);
+            fprintf(file, "      \"draw_callback\": \"%p\",\n", cost.draw_callback);
+            fprintf(file, "      \"frames\": %llu,\n", (unsigned long long)cost.frames);
+            fprintf(
+                file,
+                "      \"frames_over_budget\": %llu,\n",
+                (unsigned long long)cost.frames_over_budget);
+            fprintf(
+                file,
+                "      \"mean_us\": %llu,\n",
+                (unsigned long long)microseconds(cost.cycles / cost.frames));
+            fprintf(
+                file,
+                "      \"max_us\": %llu,\n",
+                (unsigned long long)microseconds(cost.cycles_max));
+            fprintf(
+                file,
+                "      \"counts\": {\"primitives\": %lu, \"pixels\": %lu, \"glyphs\": %lu, "
+                "\"glyph_bits\": %lu, \"clears\": %lu}\n",
+                (unsigned long)cost.counters.primitives,
+                (unsigned long)cost.counters.pixels,
+                (unsigned long)cost.counters.glyphs,
+                (unsigned long)cost.counters.glyph_bits,
+                (unsigned long)cost.counters.clears);
+            fprintf(file, "    }");
+        }
+        fprintf(file, "%s]\n", view_ports.empty() ? "" : "\n  ");
+        fprintf(file, "}\n");
+        fclose(file);
+        return true;
+    }
+};
+
+static CanvasCost canvas_cost;
+
+void canvas_cost_get_table(CanvasCostTable* table) {
+    canvas_cost.get_table(table);
+}
+
+void canvas_cost_set_table(const CanvasCostTable* table) {
+    canvas_cost.set_table(table);
+}
+
+uint64_t canvas_cost_cycles(const CanvasCostCounters* counters) {
+    return canvas_cost.get_cycles(counters);
+}
+
+void canvas_cost_view_port_begin(Canvas* canvas) {
+    canvas_cost.view_port_begin(canvas);
+}
+
+void canvas_cost_view_port_end(Canvas* canvas, const void* view_port, const void* draw_callback) {
+    canvas_cost.view_port_end(canvas, view_port, draw_callback);
+}
+
+bool canvas_cost_export(const char* path) {
+    return canvas_cost.write_report(path);
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <gui/canvas_i.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Device cycles of each counted canvas operation
+ * Defaults are rough figures for u8g2 on the 64 MHz Cortex-M4. A file named by the
+ * FAPULATOR_COST_TABLE environment variable overrides them, one `name value` pair per line
+ * with the field names below.
+ */
+typedef struct {
+    uint32_t cpu_hz; /**< core clock */
+    uint32_t frame_budget_us; /**< draw time a view port frame has to fit in */
+    uint32_t primitive; /**< call, clipping and setup of one primitive */
+    uint32_t pixel; /**< writing one pixel */
+    uint32_t glyph; /**< glyph lookup and decoder setup */
+    uint32_t glyph_bit; /**< reading one font bitstream bit */
+    uint32_t clear; /**< clearing the whole framebuffer */
+} CanvasCostTable;
+
+/** Get cycle table
+ *
+ * @param      table  table to fill
+ */
+void canvas_cost_get_table(CanvasCostTable* table);
+
+/** Set cycle table
+ *
+ * @param      table  cycle table
+ */
+void canvas_cost_set_table(const CanvasCostTable* table);
+
+/** Estimate device cycles of the operations
+ *
+ * @param      counters  operation counts
+ *
+ * @return     cycles
+ */
+uint64_t canvas_cost_cycles(const CanvasCostCounters* counters);
+
+/** Start measuring a view port draw callback
+ *
+ * @param      canvas  Canvas instance
+ */
+void canvas_cost_view_port_begin(Canvas* canvas);
+
+/** End measuring a view port draw callback
+ * Estimates are kept per view port, logged about once per second and written out at exit to
+ * the file named by FAPULATOR_COST_REPORT, canvas_cost.json by default.
+ *
+ * @param      canvas         Canvas instance
+ * @param      view_port      view port drawn
+ * @param      draw_callback  its draw callback, identifies the application in the report
+ */
+void canvas_cost_view_port_end(Canvas* canvas, const void* view_port, const void* draw_callback);
+
+/** Write per view port estimates as JSON
+ *
+ * @param      path  file path
+ *
+ * @return     true on success
+ */
+bool canvas_cost_export(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
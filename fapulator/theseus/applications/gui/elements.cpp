@@ -0,0 +1,527 @@
+#include <gui/elements.h>
+#include <gui/canvas_i.h>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "text_layout_cache.h"
+#include "font/u8g2_font_render.h"
+
+// Button icons, XBM
+static const uint8_t button_left_4x7[] = {0x08, 0x0C, 0x0E, 0x0F, 0x0E, 0x0C, 0x08};
+static const uint8_t button_right_4x7[] = {0x01, 0x03, 0x07, 0x0F, 0x07, 0x03, 0x01};
+static const uint8_t button_center_7x7[] = {0x1C, 0x22, 0x5D, 0x5D, 0x5D, 0x22, 0x1C};
+
+static uint16_t elements_text_width(Canvas* canvas, const char* text, size_t length) {
+    std::string line(text, length);
+    return canvas_string_width(canvas, line.c_str());
+}
+
+static std::shared_ptr<const TextLayout> elements_get_layout(
+    Canvas* canvas,
+    const char* text,
+    TextLayoutMode mode,
+    uint16_t width,
+    uint16_t lines,
+    const std::function<void(TextLayout&)>& build) {
+    TextLayoutKey key = {
+        text,
+        text_layout_hash(text),
+        canvas_get_font(canvas),
+        mode,
+        width,
+        lines,
+    };
+    return text_layout_cache_get(key, build);
+}
+
+static void elements_add_line(
+    Canvas* canvas,
+    TextLayout& layout,
+    const char* text,
+    size_t length,
+    bool broken,
+    const char* suffix = "") {
+    TextLayoutLine line = {std::string(text, length) + suffix, 0, broken};
+    line.width = canvas_string_width(canvas, line.text.c_str());
+    layout.width = std::max(layout.width, line.width);
+    layout.lines.push_back(std::move(line));
+}
+
+// Same estimate as the firmware: excess pixels turned into characters by the average glyph width
+static size_t elements_get_max_chars_to_fit(Canvas* canvas, const char* text, uint16_t px_left) {
+    size_t text_size = strcspn(text, "\n");
+    uint16_t len_px = elements_text_width(canvas, text, text_size);
+    if(len_px <= px_left) return text_size;
+
+    size_t excess_symbols_approximately =
+        roundf((float)(len_px - px_left) / ((float)len_px / (float)text_size));
+    if(excess_symbols_approximately == 0) return text_size;
+
+    // Reduce by at least 5 to be sure the dash fits, but always make progress
+    excess_symbols_approximately = std::max<size_t>(excess_symbols_approximately, 5);
+    if(excess_symbols_approximately + 1 >= text_size) return 1;
+    return text_size - excess_symbols_approximately - 1;
+}
+
+static void elements_break_aligned(
+    Canvas* canvas,
+    const char* text,
+    uint16_t px_left,
+    TextLayout& layout) {
+    for(const char* start = text; start[0];) {
+        size_t chars_fit = elements_get_max_chars_to_fit(canvas, start, px_left);
+        bool broken = start[chars_fit] != '\n' && start[chars_fit] != '\0';
+        elements_add_line(canvas, layout, start, chars_fit, broken, broken ? "-" : "");
+        start += chars_fit;
+        start += start[0] == '\n' ? 1 : 0;
+    }
+}
+
+static void elements_break_lines(Canvas* canvas, const char* text, TextLayout& layout) {
+    while(true) {
+        size_t length = strcspn(text, "\n");
+        elements_add_line(canvas, layout, text, length, false);
+        if(text[length] == '\0') break;
+        text += length + 1;
+    }
+}
+
+// Longest prefix of a word that fits, at least one code point
+static size_t
+    elements_split_word(Canvas* canvas, const char* text, size_t length, uint16_t width) {
+    const char* end = text;
+    U8G2FontRender_NextCodePoint(&end);
+    size_t fit = end - text;
+    while((size_t)(end - text) < length) {
+        U8G2FontRender_NextCodePoint(&end);
+        if(elements_text_width(canvas, text, end - text) > width) break;
+        fit = end - text;
+    }
+    return fit;
+}
+
+// Last line shortened until it fits with "..."
+static std::string
+    elements_strip_to_dots(Canvas* canvas, const TextLayoutLine& line, uint16_t width) {
+    std::string text = line.text;
+    while(true) {
+        std::string stripped = text + "...";
+        if(text.empty() || canvas_string_width(canvas, stripped.c_str()) <= width) {
+            return stripped;
+        }
+        // Drop the whole trailing UTF-8 sequence
+        while(((uint8_t)text.back() & 0xC0) == 0x80 && text.size() > 1) {
+            text.pop_back();
+        }
+        text.pop_back();
+    }
+}
+
+static void elements_break_words(
+    Canvas* canvas,
+    const char* text,
+    uint16_t width,
+    uint16_t max_lines,
+    TextLayout& layout) {
+    const char* line = text;
+    while(layout.lines.size() < max_lines) {
+        size_t paragraph = strcspn(line, "\n");
+
+        // Add words while the line fits
+        size_t fit = 0;
+        size_t position = 0;
+        while(position < paragraph) {
+            size_t word_end = position + strspn(line + position, " ");
+            word_end += strcspn(line + word_end, " \n");
+            if(elements_text_width(canvas, line, word_end) > width) break;
+            fit = position = word_end;
+        }
+
+        bool broken = fit < paragraph;
+        if(broken && fit == 0) {
+            fit = elements_split_word(canvas, line, paragraph, width);
+        }
+        elements_add_line(canvas, layout, line, fit, broken);
+
+        line += fit;
+        if(broken) {
+            line += strspn(line, " ");
+            // Spaces at the end of a paragraph do not make another line
+            if(line[0] == '\n') line++;
+        } else if(line[0] == '\n') {
+            line++;
+        } else {
+            return;
+        }
+        if(line[0] == '\0') return;
+    }
+    layout.truncated = true;
+    layout.ellipsis = elements_strip_to_dots(canvas, layout.lines.back(), width);
+}
+
+void elements_progress_bar(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, float progress) {
+    uint8_t height = 9;
+    uint8_t progress_length = roundf(progress * (width - 2));
+
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, x + 1, y + 1, width - 2, height - 2);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_rframe(canvas, x, y, width, height, 3);
+
+    canvas_draw_box(canvas, x + 1, y + 1, progress_length, height - 2);
+}
+
+void elements_scrollbar_pos(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t height,
+    uint16_t pos,
+    uint16_t total) {
+    // prevent overflows
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, x - 3, y, 3, height);
+    // dot line
+    canvas_set_color(canvas, ColorBlack);
+    for(uint8_t i = y; i < height + y; i += 2) {
+        canvas_draw_dot(canvas, x - 2, i);
+    }
+    // Position block
+    if(total) {
+        float block_h = ((float)height) / total;
+        canvas_draw_box(canvas, x - 3, y + (block_h * pos), 3, std::max(block_h, 1.0f));
+    }
+}
+
+void elements_scrollbar(Canvas* canvas, uint16_t pos, uint16_t total) {
+    uint8_t width = canvas_width(canvas);
+    uint8_t height = canvas_height(canvas);
+    // prevent overflows
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, width - 3, 0, 3, height);
+    // dot line
+    canvas_set_color(canvas, ColorBlack);
+    for(uint8_t i = 0; i < height; i += 2) {
+        canvas_draw_dot(canvas, width - 2, i);
+    }
+    // Position block
+    if(total) {
+        float block_h = ((float)height) / total;
+        canvas_draw_box(canvas, width - 3, block_h * pos, 3, std::max(block_h, 1.0f));
+    }
+}
+
+void elements_frame(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    canvas_draw_line(canvas, x + 2, y, x + width - 2, y);
+    canvas_draw_line(canvas, x + 1, y + height - 1, x + width, y + height - 1);
+    canvas_draw_line(canvas, x + 2, y + height, x + width - 1, y + height);
+
+    canvas_draw_line(canvas, x, y + 2, x, y + height - 2);
+    canvas_draw_line(canvas, x + width - 1, y + 1, x + width - 1, y + height - 2);
+    canvas_draw_line(canvas, x + width, y + 2, x + width, y + height - 2);
+
+    canvas_draw_dot(canvas, x + 1, y + 1);
+}
+
+void elements_button_left(Canvas* canvas, const char* str) {
+    const uint8_t button_height = 12;
+    const uint8_t vertical_offset = 3;
+    const uint8_t horizontal_offset = 3;
+    const uint8_t string_width = canvas_string_width(canvas, str);
+    const uint8_t icon_width = 4;
+    const uint8_t icon_height = 7;
+    const uint8_t icon_h_offset = 3;
+    const uint8_t icon_width_with_offset = icon_width + icon_h_offset;
+    const uint8_t icon_v_offset = icon_height + vertical_offset;
+    const uint8_t button_width = string_width + horizontal_offset * 2 + icon_width_with_offset;
+
+    const uint8_t x = 0;
+    const uint8_t y = canvas_height(canvas);
+
+    canvas_draw_box(canvas, x, y - button_height, button_width, button_height);
+    canvas_draw_line(canvas, x + button_width + 0, y, x + button_width + 0, y - button_height + 0);
+    canvas_draw_line(canvas, x + button_width + 1, y, x + button_width + 1, y - button_height + 1);
+    canvas_draw_line(canvas, x + button_width + 2, y, x + button_width + 2, y - button_height + 2);
+
+    canvas_invert_color(canvas);
+    canvas_draw_xbm(
+        canvas,
+        x + horizontal_offset,
+        y - icon_v_offset,
+        icon_width,
+        icon_height,
+        button_left_4x7);
+    canvas_draw_str(
+        canvas, x + horizontal_offset + icon_width_with_offset, y - vertical_offset, str);
+    canvas_invert_color(canvas);
+}
+
+void elements_button_right(Canvas* canvas, const char* str) {
+    const uint8_t button_height = 12;
+    const uint8_t vertical_offset = 3;
+    const uint8_t horizontal_offset = 3;
+    const uint8_t string_width = canvas_string_width(canvas, str);
+    const uint8_t icon_width = 4;
+    const uint8_t icon_height = 7;
+    const uint8_t icon_h_offset = 3;
+    const uint8_t icon_width_with_offset = icon_width + icon_h_offset;
+    const uint8_t icon_v_offset = icon_height + vertical_offset;
+    const uint8_t button_width = string_width + horizontal_offset * 2 + icon_width_with_offset;
+
+    const uint8_t x = canvas_width(canvas);
+    const uint8_t y = canvas_height(canvas);
+
+    canvas_draw_box(canvas, x - button_width, y - button_height, button_width, button_height);
+    canvas_draw_line(canvas, x - button_width - 1, y, x - button_width - 1, y - button_height + 0);
+    canvas_draw_line(canvas, x - button_width - 2, y, x - button_width - 2, y - button_height + 1);
+    canvas_draw_line(canvas, x - button_width - 3, y, x - button_width - 3, y - button_height + 2);
+
+    canvas_invert_color(canvas);
+    canvas_draw_str(canvas, x - button_width + horizontal_offset, y - vertical_offset, str);
+    canvas_draw_xbm(
+        canvas,
+        x - horizontal_offset - icon_width,
+        y - icon_v_offset,
+        icon_width,
+        icon_height,
+        button_right_4x7);
+    canvas_invert_color(canvas);
+}
+
+void elements_button_center(Canvas* canvas, const char* str) {
+    const uint8_t button_height = 12;
+    const uint8_t vertical_offset = 3;
+    const uint8_t horizontal_offset = 1;
+    const uint8_t string_width = canvas_string_width(canvas, str);
+    const uint8_t icon_width = 7;
+    const uint8_t icon_height = 7;
+    const uint8_t icon_h_offset = 3;
+    const uint8_t icon_width_with_offset = icon_width + icon_h_offset;
+    const uint8_t icon_v_offset = icon_height + vertical_offset;
+    const uint8_t button_width = string_width + horizontal_offset * 2 + icon_width_with_offset;
+
+    const uint8_t x = (canvas_width(canvas) - button_width) / 2;
+    const uint8_t y = canvas_height(canvas);
+
+    canvas_draw_box(canvas, x, y - button_height, button_width, button_height);
+
+    canvas_draw_line(canvas, x - 1, y, x - 1, y - button_height + 0);
+    canvas_draw_line(canvas, x - 2, y, x - 2, y - button_height + 1);
+    canvas_draw_line(canvas, x - 3, y, x - 3, y - button_height + 2);
+
+    canvas_draw_line(canvas, x + button_width + 0, y, x + button_width + 0, y - button_height + 0);
+    canvas_draw_line(canvas, x + button_width + 1, y, x + button_width + 1, y - button_height + 1);
+    canvas_draw_line(canvas, x + button_width + 2, y, x + button_width + 2, y - button_height + 2);
+
+    canvas_invert_color(canvas);
+    canvas_draw_xbm(
+        canvas,
+        x + horizontal_offset,
+        y - icon_v_offset,
+        icon_width,
+        icon_height,
+        button_center_7x7);
+    canvas_draw_str(
+        canvas, x + horizontal_offset + icon_width_with_offset, y - vertical_offset, str);
+    canvas_invert_color(canvas);
+}
+
+void elements_multiline_text_aligned(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    const char* text) {
+    uint8_t font_height = canvas_current_font_height(canvas);
+
+    uint16_t px_left = 0;
+    if(horizontal == AlignCenter) {
+        if(x > (canvas_width(canvas) / 2)) {
+            px_left = (canvas_width(canvas) - x) * 2;
+        } else {
+            px_left = x * 2;
+        }
+    } else if(horizontal == AlignLeft) {
+        px_left = canvas_width(canvas) - x;
+    } else if(horizontal == AlignRight) {
+        px_left = x;
+    } else {
+        abort();
+    }
+
+    auto layout = elements_get_layout(
+        canvas, text, TextLayoutMode::Aligned, px_left, 0, [&](TextLayout& target) {
+            elements_break_aligned(canvas, text, px_left, target);
+        });
+    size_t lines_count = layout->lines.size();
+    if(lines_count == 0) return;
+
+    if(vertical == AlignBottom) {
+        y -= font_height * (lines_count - 1);
+    } else if(vertical == AlignCenter) {
+        y -= (font_height * (lines_count - 1)) / 2;
+    }
+
+    for(const TextLayoutLine& line : layout->lines) {
+        if(line.broken && (y + font_height) > canvas_height(canvas)) {
+            // Last visible line, dash turns into dots
+            std::string stripped = line.text.substr(0, line.text.size() - 1) + "...";
+            canvas_draw_str_aligned(canvas, x, y, horizontal, vertical, stripped.c_str());
+        } else {
+            canvas_draw_str_aligned(canvas, x, y, horizontal, vertical, line.text.c_str());
+        }
+        y += font_height;
+        if(y > canvas_height(canvas)) {
+            break;
+        }
+    }
+}
+
+void elements_multiline_text(Canvas* canvas, uint8_t x, uint8_t y, const char* text) {
+    uint8_t font_height = canvas_current_font_height(canvas);
+
+    auto layout = elements_get_layout(
+        canvas, text, TextLayoutMode::Lines, 0, 0, [&](TextLayout& target) {
+            elements_break_lines(canvas, text, target);
+        });
+    for(const TextLayoutLine& line : layout->lines) {
+        canvas_draw_str(canvas, x, y, line.text.c_str());
+        y += font_height;
+        if(y >= 64) break;
+    }
+}
+
+void elements_multiline_text_framed(Canvas* canvas, uint8_t x, uint8_t y, const char* text) {
+    uint8_t font_y = canvas_current_font_height(canvas);
+
+    auto layout = elements_get_layout(
+        canvas, text, TextLayoutMode::Lines, 0, 0, [&](TextLayout& target) {
+            elements_break_lines(canvas, text, target);
+        });
+    uint16_t str_width = layout->width;
+    uint8_t lines = layout->lines.size();
+
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, x, y - font_y, str_width + 8, font_y * lines + 4);
+    canvas_set_color(canvas, ColorBlack);
+    elements_multiline_text(canvas, x + 4, y - 1, text);
+    elements_frame(canvas, x, y - font_y, str_width + 8, font_y * lines + 4);
+}
+
+void elements_slightly_rounded_frame(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height) {
+    canvas_draw_rframe(canvas, x, y, width, height, 1);
+}
+
+void elements_slightly_rounded_box(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height) {
+    canvas_draw_rbox(canvas, x, y, width, height, 1);
+}
+
+void elements_bold_rounded_frame(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height) {
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, x + 2, y + 2, width - 3, height - 3);
+    canvas_set_color(canvas, ColorBlack);
+
+    canvas_draw_line(canvas, x + 3, y, x + width - 3, y);
+    canvas_draw_line(canvas, x + 2, y + 1, x + width - 2, y + 1);
+
+    canvas_draw_line(canvas, x, y + 3, x, y + height - 3);
+    canvas_draw_line(canvas, x + 1, y + 2, x + 1, y + height - 2);
+
+    canvas_draw_line(canvas, x + width, y + 3, x + width, y + height - 3);
+    canvas_draw_line(canvas, x + width - 1, y + 2, x + width - 1, y + height - 2);
+
+    canvas_draw_line(canvas, x + 3, y + height, x + width - 3, y + height);
+    canvas_draw_line(canvas, x + 2, y + height - 1, x + width - 2, y + height - 1);
+
+    canvas_draw_dot(canvas, x + 2, y + 2);
+    canvas_draw_dot(canvas, x + 3, y + 1);
+    canvas_draw_dot(canvas, x + 1, y + 3);
+
+    canvas_draw_dot(canvas, x + width - 2, y + 2);
+    canvas_draw_dot(canvas, x + width - 3, y + 1);
+    canvas_draw_dot(canvas, x + width - 1, y + 3);
+
+    canvas_draw_dot(canvas, x + 2, y + height - 2);
+    canvas_draw_dot(canvas, x + 3, y + height - 1);
+    canvas_draw_dot(canvas, x + 1, y + height - 3);
+
+    canvas_draw_dot(canvas, x + width - 2, y + height - 2);
+    canvas_draw_dot(canvas, x + width - 3, y + height - 1);
+    canvas_draw_dot(canvas, x + width - 1, y + height - 3);
+}
+
+void elements_bubble(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    canvas_draw_rframe(canvas, x + 4, y, width, height, 3);
+    uint8_t y_corner = y + height * 2 / 3;
+    canvas_draw_line(canvas, x, y_corner, x + 4, y_corner - 4);
+    canvas_draw_line(canvas, x, y_corner, x + 4, y_corner + 4);
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_line(canvas, x + 4, y_corner - 3, x + 4, y_corner + 3);
+    canvas_set_color(canvas, ColorBlack);
+}
+
+void elements_text_box(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    Align horizontal,
+    Align vertical,
+    const char* text,
+    bool strip_to_dots) {
+    uint8_t font_height = canvas_current_font_height(canvas);
+    uint16_t max_lines = std::max(height / font_height, 1);
+
+    auto layout = elements_get_layout(
+        canvas, text, TextLayoutMode::WordWrap, width, max_lines, [&](TextLayout& target) {
+            elements_break_words(canvas, text, width, max_lines, target);
+        });
+    uint8_t lines_height = font_height * layout->lines.size();
+
+    uint8_t line_x = x;
+    if(horizontal == AlignCenter) {
+        line_x += width / 2;
+    } else if(horizontal == AlignRight) {
+        line_x += width;
+    } else if(horizontal != AlignLeft) {
+        abort();
+    }
+
+    uint8_t line_y = y;
+    if(vertical == AlignCenter) {
+        line_y += (height - lines_height) / 2;
+    } else if(vertical == AlignBottom) {
+        line_y += height - lines_height;
+    } else if(vertical != AlignTop) {
+        abort();
+    }
+
+    for(size_t i = 0; i < layout->lines.size(); i++) {
+        const TextLayoutLine& line = layout->lines[i];
+        if(strip_to_dots && layout->truncated && i + 1 == layout->lines.size()) {
+            canvas_draw_str_aligned(
+                canvas, line_x, line_y, horizontal, AlignTop, layout->ellipsis.c_str());
+        } else {
+            canvas_draw_str_aligned(
+                canvas, line_x, line_y, horizontal, AlignTop, line.text.c_str());
+        }
+        line_y += font_height;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include "fonts.h"
+
+/* Compile time u8g2 font decoder
+ * Decodes glyph bitstreams into the same GlyphBitmap layout the glyph cache produces at runtime,
+ * so fonts known at build time end up as read-only tables.
+ */
+
+// Reads u8g2 bitfields, LSB first across bytes
+class FontBitReader {
+private:
+    const uint8_t* data;
+    size_t position = 0;
+
+public:
+    constexpr FontBitReader(const uint8_t* data)
+        : data(data) {
+    }
+
+    constexpr uint8_t get_unsigned(uint8_t count) {
+        uint8_t value = 0;
+        for(uint8_t i = 0; i < count; i++, position++) {
+            value |= ((data[position / 8] >> (position % 8)) & 1) << i;
+        }
+        return value;
+    }
+
+    constexpr int8_t get_signed(uint8_t count) {
+        return (int8_t)(get_unsigned(count) - (1 << (count - 1)));
+    }
+
+    constexpr size_t get_position() const {
+        return position;
+    }
+};
+
+struct FontDecoderHeader {
+    uint8_t zero_bit_width;
+    uint8_t one_bit_width;
+    uint8_t glyph_width;
+    uint8_t glyph_height;
+    uint8_t glyph_x_offset;
+    uint8_t glyph_y_offset;
+    uint8_t glyph_pitch;
+    uint16_t offset_0x100;
+};
+
+struct FontDecoderSize {
+    size_t glyphs;
+    size_t bitmap_bytes;
+};
+
+constexpr uint16_t font_decoder_word(const uint8_t* data) {
+    return data[0] << 8 | data[1];
+}
+
+constexpr FontDecoderHeader font_decoder_header(const uint8_t* font) {
+    return {
+        font[2],
+        font[3],
+        font[4],
+        font[5],
+        font[6],
+        font[7],
+        font[8],
+        (uint16_t)(U8G2_FONT_HEADER_SIZE + font_decoder_word(font + 21)),
+    };
+}
+
+// Calls `callback(encoding, bitstream)` for every glyph, in font order which is ascending
+template <typename Callback>
+constexpr void font_decoder_for_each(const uint8_t* font, Callback callback) {
+    size_t position = U8G2_FONT_HEADER_SIZE;
+    while(font[position + 1] != 0) {
+        callback((uint16_t)font[position], font + position + 2);
+        position += font[position + 1];
+    }
+
+    // Unicode records start right after the jump table and run until a zero encoding
+    FontDecoderHeader header = font_decoder_header(font);
+    position = header.offset_0x100 + font_decoder_word(font + header.offset_0x100);
+    while(font_decoder_word(font + position) != 0 && font[position + 2] != 0) {
+        callback(font_decoder_word(font + position), font + position + 3);
+        position += font[position + 2];
+    }
+}
+
+// Decodes glyph metrics, `bitmap` is left unset
+constexpr GlyphBitmap font_decoder_metrics(
+    const FontDecoderHeader& header,
+    FontBitReader& reader) {
+    GlyphBitmap glyph = {};
+    glyph.width = reader.get_unsigned(header.glyph_width);
+    glyph.height = reader.get_unsigned(header.glyph_height);
+    glyph.x_offset = reader.get_signed(header.glyph_x_offset);
+    glyph.y_offset = reader.get_signed(header.glyph_y_offset);
+    glyph.pitch = reader.get_signed(header.glyph_pitch);
+    glyph.stride = (glyph.width + 7) / 8;
+    return glyph;
+}
+
+// Decodes the run length encoded glyph box into rows of `glyph.stride` bytes, or only reads it
+// past when `bitmap` is null
+constexpr void font_decoder_bitmap(
+    const FontDecoderHeader& header,
+    FontBitReader& reader,
+    const GlyphBitmap& glyph,
+    uint8_t* bitmap) {
+    size_t pixels = glyph.width * glyph.height;
+    size_t pixel = 0;
+    while(pixel < pixels) {
+        uint8_t zeros = reader.get_unsigned(header.zero_bit_width);
+        uint8_t ones = reader.get_unsigned(header.one_bit_width);
+        size_t repeat = 0;
+        while(reader.get_unsigned(1) == 1) {
+            repeat++;
+        }
+
+        for(size_t run = 0; run <= repeat; run++) {
+            pixel += zeros;
+            if(bitmap == nullptr) {
+                pixel += ones;
+                continue;
+            }
+            for(uint8_t i = 0; i < ones && pixel < pixels; i++, pixel++) {
+                size_t x = pixel % glyph.width;
+                size_t y = pixel / glyph.width;
+                bitmap[y * glyph.stride + x / 8] |= 1 << (x % 8);
+            }
+        }
+    }
+}
+
+constexpr FontDecoderSize font_decoder_size(const uint8_t* font) {
+    FontDecoderHeader header = font_decoder_header(font);
+    FontDecoderSize size = {};
+    font_decoder_for_each(font, [&](uint16_t encoding, const uint8_t* data) {
+        FontBitReader reader(data);
+        GlyphBitmap glyph = font_decoder_metrics(header, reader);
+        size.glyphs++;
+        size.bitmap_bytes += glyph.stride * glyph.height;
+    });
+    return size;
+}
+
+template <size_t Bytes>
+constexpr std::array<uint8_t, Bytes> font_decoder_bitmaps(const uint8_t* font) {
+    FontDecoderHeader header = font_decoder_header(font);
+    std::array<uint8_t, Bytes> bitmaps = {};
+    size_t offset = 0;
+    font_decoder_for_each(font, [&](uint16_t encoding, const uint8_t* data) {
+        FontBitReader reader(data);
+        GlyphBitmap glyph = font_decoder_metrics(header, reader);
+        if(glyph.width && glyph.height) {
+            font_decoder_bitmap(header, reader, glyph, bitmaps.data() + offset);
+        }
+        offset += glyph.stride * glyph.height;
+    });
+    return bitmaps;
+}
+
+// `bitmaps` must be the table made by font_decoder_bitmaps for the same font
+template <size_t Glyphs>
+constexpr std::array<GlyphBitmap, Glyphs>
+    font_decoder_glyphs(const uint8_t* font, const uint8_t* bitmaps) {
+    FontDecoderHeader header = font_decoder_header(font);
+    std::array<GlyphBitmap, Glyphs> glyphs = {};
+    size_t index = 0;
+    size_t offset = 0;
+    font_decoder_for_each(font, [&](uint16_t encoding, const uint8_t* data) {
+        FontBitReader reader(data);
+        GlyphBitmap glyph = font_decoder_metrics(header, reader);
+        if(glyph.width && glyph.height) {
+            font_decoder_bitmap(header, reader, glyph, nullptr);
+        }
+        glyph.bits = reader.get_position();
+        glyph.bitmap = bitmaps + offset;
+        offset += glyph.stride * glyph.height;
+        glyphs[index++] = glyph;
+    });
+    return glyphs;
+}
+
+template <size_t Glyphs>
+constexpr std::array<uint16_t, Glyphs> font_decoder_encodings(const uint8_t* font) {
+    std::array<uint16_t, Glyphs> encodings = {};
+    size_t index = 0;
+    font_decoder_for_each(
+        font, [&](uint16_t encoding, const uint8_t* data) { encodings[index++] = encoding; });
+    return encodings;
+}
+
+constexpr std::array<uint16_t, U8G2_FONT_INDEX_SIZE>
+    font_decoder_ascii_index(const uint8_t* font) {
+    std::array<uint16_t, U8G2_FONT_INDEX_SIZE> ascii_index = {};
+    for(auto& index : ascii_index) {
+        index = FONT_GLYPH_NONE;
+    }
+    uint16_t index = 0;
+    font_decoder_for_each(font, [&](uint16_t encoding, const uint8_t* data) {
+        if(encoding < U8G2_FONT_INDEX_SIZE) {
+            ascii_index[encoding] = index;
+        }
+        index++;
+    });
+    return ascii_index;
+}
+
+constexpr FontMetrics font_decoder_font_metrics(const uint8_t* font) {
+    FontDecoderHeader header = font_decoder_header(font);
+    FontMetrics metrics = {};
+    metrics.font = font;
+    metrics.max_char_height = font[10];
+    metrics.ascent_A = (int8_t)font[13];
+    font_decoder_for_each(font, [&](uint16_t encoding, const uint8_t* data) {
+        if(encoding >= U8G2_FONT_INDEX_SIZE) return;
+        FontBitReader reader(data);
+        GlyphBitmap glyph = font_decoder_metrics(header, reader);
+        metrics.ascii[encoding] = {true, glyph.width, glyph.x_offset, glyph.pitch};
+    });
+    return metrics;
+}
+
+// Read-only glyph tables of a font, all evaluated at compile time
+template <const uint8_t* Font>
+struct FontDecoderTables {
+    static constexpr FontDecoderSize size = font_decoder_size(Font);
+    static constexpr std::array<uint8_t, size.bitmap_bytes> bitmaps =
+        font_decoder_bitmaps<size.bitmap_bytes>(Font);
+    static constexpr std::array<GlyphBitmap, size.glyphs> glyphs =
+        font_decoder_glyphs<size.glyphs>(Font, bitmaps.data());
+    static constexpr std::array<uint16_t, size.glyphs> encodings =
+        font_decoder_encodings<size.glyphs>(Font);
+    static constexpr std::array<uint16_t, U8G2_FONT_INDEX_SIZE> ascii_index =
+        font_decoder_ascii_index(Font);
+
+    static constexpr FontMetrics metrics = font_decoder_font_metrics(Font);
+
+    static constexpr FontGlyphTable table = {
+        Font,
+        glyphs.data(),
+        encodings.data(),
+        (uint16_t)size.glyphs,
+        ascii_index.data(),
+    };
+};
\ No newline at end of file
@@ -1,4 +1,8 @@
 #include "fonts.h"
+#include "font_decoder.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
 
 /*
   Fontname: -Adobe-Helvetica-Bold-R-Normal--11-80-100-100-P-60-ISO10646-1
@@ -6,7 +10,7 @@
   Glyphs: 95/756
   BBX Build Mode: 0
 */
-const uint8_t u8g2_font_helvB08_tr[1062] =
+constexpr uint8_t u8g2_font_helvB08_tr[1062] =
     "_\0\3\3\4\4\2\4\5\13\13\377\376\10\376\10\376\1d\2\317\4\11 \5\0\346\4!\10\202#"
     "\305A\22\23\42\10\63wED%\0#\20w\241U$\30\211\231\42!S$\30\211\1$\17\245\236"
     "Ul\222B[\212HRf!\0%\22\207\42\216L\42\11I\242\341hD\24\211\314$\0&\20\207"
@@ -48,7 +52,7 @@ const uint8_t u8g2_font_helvB08_tr[1062] =
   Glyphs: 95/165
   BBX Build Mode: 0
 */
-const uint8_t u8g2_font_haxrcorp4089_tr[946] =
+constexpr uint8_t u8g2_font_haxrcorp4089_tr[946] =
     "_\0\3\2\4\4\1\4\5\10\12\0\376\7\376\10\377\1\71\2~\3\225 \5\0Q\2!\7qQ"
     "bP\2\42\7\63\231\42\261\4#\13U\323\246\62(\225A\251\0$\16\225\317*[*J\266%J"
     "e\213\0%\14w\21'T\242\326R\213\230\0&\14v\361F\213\332$)\321\242%'\5\61Yb"
@@ -86,7 +90,7 @@ const uint8_t u8g2_font_haxrcorp4089_tr[946] =
   Glyphs: 96/256
   BBX Build Mode: 2
 */
-const uint8_t u8g2_font_profont11_mr[1203] =
+constexpr uint8_t u8g2_font_profont11_mr[1203] =
     "`\2\3\2\3\4\1\2\4\6\13\0\376\7\376\10\377\1{\3\42\4\226 \7\336\370\371\67\0!\12"
     "\336\370\11iw\60\247\0\42\14\336\370\201$K\262$\347\23\0#\16\336\370\341$\32\244$\32\244$"
     "g\5$\16\336\370\221pJ:\216I\247\61\207\0%\15\336\370\341!\351\242%\231\322SN&\16\336"
@@ -132,7 +136,7 @@ const uint8_t u8g2_font_profont11_mr[1203] =
   Glyphs: 18/256
   BBX Build Mode: 0
 */
-const uint8_t u8g2_font_profont22_tn[345] =
+constexpr uint8_t u8g2_font_profont22_tn[345] =
     "\22\0\4\4\4\5\3\4\5\13\24\0\374\16\374\20\376\0\0\0\0\1< \5\0\210\34*\23\252\310"
     "\234\4\12\22\42\204\211!#L$\22(\10\0+\15\252\250\234\4\312\350A!\201\62\2,\17\225L"
     "\134\204\220 \62F\310\210i\302\0-\6&\354\34\30.\12D\236<D\240\20\1\0/\34KI<"
@@ -143,4 +147,94 @@ const uint8_t u8g2_font_profont22_tn[345] =
     "\352\210\34\36\34\24\210$\341@\11\211\25\32\201\306\10\0\66\25\352\210\134\314\34\31'\20I\12Q\305"
     "hVh\4\32#\0\67\17\352\210\34\36\24\224\335\260\331\11\224#\0\70\31\352\210\134\314\240\30T\214"
     "\230\10Ab\314\240\30T\214X\241\21h\214\0\71\25\352\210\134\314\240\30T\214f\245D$A(n"
-    "\310\31#\0:\15\244\236<D\240\20*\2\205\10\0\0\0\0\4\377\377\0";
\ No newline at end of file
+    "\310\31#\0:\15\244\236<D\240\20*\2\205\10\0\0\0\0\4\377\377\0";
+
+typedef struct {
+    const uint8_t* font;
+    std::once_flag once;
+    U8G2FontIndex_t index;
+} FontIndexSlot;
+
+static FontIndexSlot font_index_slots[] = {
+    {u8g2_font_helvB08_tr},
+    {u8g2_font_haxrcorp4089_tr},
+    {u8g2_font_profont11_mr},
+    {u8g2_font_profont22_tn},
+};
+
+static std::mutex font_index_mutex;
+static std::map<const uint8_t*, U8G2FontIndex_t> font_index_map;
+
+const U8G2FontIndex_t* font_get_index(const uint8_t* font) {
+    // Built-in fonts are indexed once without taking a lock on every lookup
+    for(FontIndexSlot& slot : font_index_slots) {
+        if(slot.font == font) {
+            std::call_once(slot.once, [&slot]() { U8G2FontIndex_Init(&slot.index, slot.font); });
+            return &slot.index;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(font_index_mutex);
+    auto it = font_index_map.find(font);
+    if(it == font_index_map.end()) {
+        it = font_index_map.emplace(font, U8G2FontIndex_t()).first;
+        U8G2FontIndex_Init(&it->second, font);
+    }
+    return &it->second;
+}
+
+static const FontGlyphTable* font_glyph_tables[] = {
+    &FontDecoderTables<u8g2_font_helvB08_tr>::table,
+    &FontDecoderTables<u8g2_font_haxrcorp4089_tr>::table,
+    &FontDecoderTables<u8g2_font_profont11_mr>::table,
+    &FontDecoderTables<u8g2_font_profont22_tn>::table,
+};
+
+const FontGlyphTable* font_get_glyph_table(const uint8_t* font) {
+    for(const FontGlyphTable* table : font_glyph_tables) {
+        if(table->font == font) {
+            return table;
+        }
+    }
+    return NULL;
+}
+
+static const FontMetrics* font_metrics[] = {
+    &FontDecoderTables<u8g2_font_helvB08_tr>::metrics,
+    &FontDecoderTables<u8g2_font_haxrcorp4089_tr>::metrics,
+    &FontDecoderTables<u8g2_font_profont11_mr>::metrics,
+    &FontDecoderTables<u8g2_font_profont22_tn>::metrics,
+};
+
+static std::mutex font_metrics_mutex;
+static std::map<const uint8_t*, FontMetrics> font_metrics_map;
+
+const FontMetrics* font_get_metrics(const uint8_t* font) {
+    for(const FontMetrics* metrics : font_metrics) {
+        if(metrics->font == font) {
+            return metrics;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(font_metrics_mutex);
+    auto it = font_metrics_map.find(font);
+    if(it == font_metrics_map.end()) {
+        it = font_metrics_map.emplace(font, font_decoder_font_metrics(font)).first;
+    }
+    return &it->second;
+}
+
+const GlyphBitmap* font_glyph_table_get(const FontGlyphTable* table, uint16_t encoding) {
+    uint16_t index = FONT_GLYPH_NONE;
+    if(encoding < U8G2_FONT_INDEX_SIZE) {
+        index = table->ascii_index[encoding];
+    } else {
+        const uint16_t* begin = table->encodings;
+        const uint16_t* end = table->encodings + table->glyph_count;
+        const uint16_t* it = std::lower_bound(begin, end, encoding);
+        if(it != end && *it == encoding) {
+            index = it - begin;
+        }
+    }
+    return index == FONT_GLYPH_NONE ? NULL : &table->glyphs[index];
+}
\ No newline at end of file
@@ -1,7 +1,94 @@
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
+#include "u8g2_font_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FONT_GLYPH_NONE 0xFFFF
+
+/** Decoded glyph
+ * Rows are `stride` bytes each, pixel x of a row is bit (x % 8) of byte x / 8
+ */
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    int8_t x_offset;
+    int8_t y_offset;
+    int8_t pitch;
+    uint8_t stride;
+    uint16_t bits; // bitstream bits the u8g2 decoder reads to draw the glyph
+    const uint8_t* bitmap;
+} GlyphBitmap;
+
+/** Glyphs of a built-in font, decoded at compile time
+ * Glyphs are in ascending encoding order, `ascii_index` maps code points below 0x100 to glyphs
+ */
+typedef struct {
+    const uint8_t* font;
+    const GlyphBitmap* glyphs;
+    const uint16_t* encodings;
+    uint16_t glyph_count;
+    const uint16_t* ascii_index;
+} FontGlyphTable;
+
+/** Advance and box width of a glyph, all that is needed to measure text */
+typedef struct {
+    bool present;
+    uint8_t width;
+    int8_t x_offset;
+    int8_t pitch;
+} GlyphMetrics;
+
+/** Font wide metrics and metrics of the glyphs below 0x100, indexed by code point */
+typedef struct {
+    const uint8_t* font;
+    uint8_t max_char_height;
+    int8_t ascent_A;
+    GlyphMetrics ascii[U8G2_FONT_INDEX_SIZE];
+} FontMetrics;
 
 extern const uint8_t u8g2_font_helvB08_tr[];
 extern const uint8_t u8g2_font_haxrcorp4089_tr[];
 extern const uint8_t u8g2_font_profont11_mr[];
-extern const uint8_t u8g2_font_profont22_tn[];
\ No newline at end of file
+extern const uint8_t u8g2_font_profont22_tn[];
+
+/** Get glyph lookup index of the font, built on first use and kept for program lifetime
+ *
+ * @param      font  u8g2 font data
+ *
+ * @return     font index
+ */
+const U8G2FontIndex_t* font_get_index(const uint8_t* font);
+
+/** Get compile time glyph table of the font
+ *
+ * @param      font  u8g2 font data
+ *
+ * @return     glyph table or NULL if the font is not built-in
+ */
+const FontGlyphTable* font_get_glyph_table(const uint8_t* font);
+
+/** Get metrics of the font
+ * Built-in fonts have them computed at compile time, others on first use
+ *
+ * @param      font  u8g2 font data
+ *
+ * @return     font metrics
+ */
+const FontMetrics* font_get_metrics(const uint8_t* font);
+
+/** Find glyph in the table
+ *
+ * @param      table     glyph table
+ * @param      encoding  code point
+ *
+ * @return     glyph or NULL if font has no such glyph
+ */
+const GlyphBitmap* font_glyph_table_get(const FontGlyphTable* table, uint16_t encoding);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
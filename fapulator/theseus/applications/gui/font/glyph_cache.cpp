@@ -0,0 +1,198 @@
+#include "glyph_cache.h"
+#include "fonts.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string.h>
+
+// Bump allocator, glyphs are never freed so the arena only grows
+class GlyphArena {
+private:
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+    std::vector<std::unique_ptr<uint8_t[]>> blocks;
+    size_t block_used = BLOCK_SIZE;
+    size_t bytes_used = 0;
+    size_t bytes_reserved = 0;
+
+public:
+    void* allocate(size_t size, size_t align) {
+        size_t offset = (block_used + align - 1) & ~(align - 1);
+        if(offset + size > BLOCK_SIZE) {
+            size_t block_size = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+            blocks.emplace_back(new uint8_t[block_size]);
+            bytes_reserved += block_size;
+            offset = 0;
+        }
+        block_used = offset + size;
+        bytes_used += size;
+        return blocks.back().get() + offset;
+    }
+
+    size_t get_bytes_used() {
+        return bytes_used;
+    }
+
+    size_t get_bytes_reserved() {
+        return bytes_reserved;
+    }
+};
+
+struct FontGlyphCache {
+private:
+    const uint8_t* font;
+    // Compile time glyphs of a built-in font, NULL for fonts decoded at run time
+    const FontGlyphTable* table;
+    // Glyphs below 0x100 are read without a lock, absent glyphs point to `missing`
+    std::atomic<const GlyphBitmap*> glyphs[U8G2_FONT_INDEX_SIZE];
+    std::map<uint16_t, const GlyphBitmap*> unicode_glyphs;
+
+public:
+    static const GlyphBitmap missing;
+
+    FontGlyphCache(const uint8_t* font)
+        : font(font)
+        , table(font_get_glyph_table(font)) {
+        for(auto& glyph : glyphs) {
+            glyph.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    const uint8_t* get_font() {
+        return font;
+    }
+
+    const FontGlyphTable* get_table() {
+        return table;
+    }
+
+    const GlyphBitmap* find(uint16_t encoding) {
+        if(encoding < U8G2_FONT_INDEX_SIZE) {
+            return glyphs[encoding].load(std::memory_order_acquire);
+        }
+        auto it = unicode_glyphs.find(encoding);
+        return it == unicode_glyphs.end() ? nullptr : it->second;
+    }
+
+    void store(uint16_t encoding, const GlyphBitmap* glyph) {
+        if(encoding < U8G2_FONT_INDEX_SIZE) {
+            glyphs[encoding].store(glyph, std::memory_order_release);
+        } else {
+            unicode_glyphs[encoding] = glyph;
+        }
+    }
+};
+
+const GlyphBitmap FontGlyphCache::missing = {};
+
+class GlyphCache {
+private:
+    std::mutex mutex;
+    GlyphArena arena;
+    size_t glyph_count = 0;
+    std::map<const uint8_t*, std::unique_ptr<FontGlyphCache>> fonts;
+
+    // Glyph decode target, glyphs are at most 255x255 pixels
+    static constexpr size_t DECODE_STRIDE = (UINT8_MAX + 7) / 8;
+    uint8_t decode_buffer[UINT8_MAX][DECODE_STRIDE];
+
+    static void decode_span_fg(uint8_t x, uint8_t y, uint8_t length, void* context) {
+        GlyphCache* cache = (GlyphCache*)context;
+        uint8_t* row = cache->decode_buffer[y];
+        for(size_t i = x; i < (size_t)x + length; i++) {
+            row[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    static void decode_span_bg(uint8_t x, uint8_t y, uint8_t length, void* context) {
+        // Background is implied by the glyph box
+    }
+
+    const GlyphBitmap* decode(const uint8_t* font, uint16_t encoding) {
+        U8G2FontRender_t render =
+            U8G2FontRender(font_get_index(font), decode_span_fg, decode_span_bg, this);
+
+        U8G2FontGlyph_t glyph;
+        const uint8_t* bitstream = U8G2FontIndex_GetGlyph(render.index, encoding);
+        memset(decode_buffer, 0, sizeof(decode_buffer));
+        if(U8G2FontRender_DecodeGlyph(&render, encoding, &glyph) != U8G2FontRender_OK) {
+            return &FontGlyphCache::missing;
+        }
+
+        // Keep only the glyph box, rows packed to the glyph width
+        uint8_t stride = (glyph.width + 7) / 8;
+        GlyphBitmap* bitmap =
+            (GlyphBitmap*)arena.allocate(sizeof(GlyphBitmap), alignof(GlyphBitmap));
+        uint8_t* data = (uint8_t*)arena.allocate(stride * glyph.height, 1);
+        for(size_t y = 0; y < glyph.height; y++) {
+            memcpy(data + y * stride, decode_buffer[y], stride);
+        }
+
+        bitmap->width = glyph.width;
+        bitmap->height = glyph.height;
+        bitmap->x_offset = glyph.x_offset;
+        bitmap->y_offset = glyph.y_offset;
+        bitmap->pitch = glyph.pitch;
+        bitmap->stride = stride;
+        bitmap->bits = (glyph.data - bitstream) * 8 + glyph.bit_pos;
+        bitmap->bitmap = data;
+        glyph_count++;
+
+        return bitmap;
+    }
+
+public:
+    FontGlyphCache* get_font_cache(const uint8_t* font) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = fonts.find(font);
+        if(it == fonts.end()) {
+            it = fonts.emplace(font, std::make_unique<FontGlyphCache>(font)).first;
+        }
+        return it->second.get();
+    }
+
+    const GlyphBitmap* get(FontGlyphCache* font_cache, uint16_t encoding) {
+        if(font_cache->get_table() != NULL) {
+            return font_glyph_table_get(font_cache->get_table(), encoding);
+        }
+
+        const GlyphBitmap* glyph = nullptr;
+        if(encoding < U8G2_FONT_INDEX_SIZE) {
+            glyph = font_cache->find(encoding);
+        }
+
+        if(glyph == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            glyph = font_cache->find(encoding);
+            if(glyph == nullptr) {
+                glyph = decode(font_cache->get_font(), encoding);
+                font_cache->store(encoding, glyph);
+            }
+        }
+
+        return glyph == &FontGlyphCache::missing ? nullptr : glyph;
+    }
+
+    void get_stats(GlyphCacheStats* stats) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats->glyphs = glyph_count;
+        stats->bytes_used = arena.get_bytes_used();
+        stats->bytes_reserved = arena.get_bytes_reserved();
+    }
+};
+
+static GlyphCache glyph_cache;
+
+FontGlyphCache* glyph_cache_get_font(const uint8_t* font) {
+    return glyph_cache.get_font_cache(font);
+}
+
+const GlyphBitmap* glyph_cache_get(FontGlyphCache* font_cache, uint16_t encoding) {
+    return glyph_cache.get(font_cache, encoding);
+}
+
+void glyph_cache_get_stats(GlyphCacheStats* stats) {
+    glyph_cache.get_stats(stats);
+}
\ No newline at end of file
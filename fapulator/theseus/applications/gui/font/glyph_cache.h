@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "fonts.h"
+
+typedef struct {
+    size_t glyphs;
+    size_t bytes_used;
+    size_t bytes_reserved;
+} GlyphCacheStats;
+
+/** Glyphs of one font, resolved with glyph_cache_get_font */
+typedef struct FontGlyphCache FontGlyphCache;
+
+/** Get glyphs of a font
+ * Takes the cache lock, so resolve it when the font changes rather than for every glyph
+ *
+ * @param      font  u8g2 font data
+ *
+ * @return     glyphs of the font, valid for the lifetime of the program
+ */
+FontGlyphCache* glyph_cache_get_font(const uint8_t* font);
+
+/** Get decoded glyph
+ * Built-in fonts are served from their compile time tables, other fonts are decoded and stored
+ * on first use. Lookups below 0x100 only take the lock for that first decode.
+ *
+ * @param      font_cache  glyphs of the font
+ * @param      encoding    code point
+ *
+ * @return     glyph or NULL if font has no such glyph
+ */
+const GlyphBitmap* glyph_cache_get(FontGlyphCache* font_cache, uint16_t encoding);
+
+/** Get memory used by runtime decoded glyphs, shared by all canvases
+ *
+ * @param      stats  stats to fill
+ */
+void glyph_cache_get_stats(GlyphCacheStats* stats);
\ No newline at end of file
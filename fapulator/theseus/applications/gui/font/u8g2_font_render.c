@@ -8,65 +8,191 @@
 
 uint8_t font_get_unsigned_bits(U8G2FontGlyph_t* glyph, uint8_t count);
 int8_t font_get_signed_bits(U8G2FontGlyph_t* glyph, uint8_t count);
-uint16_t font_get_start_symbol_search_postition(U8G2FontRender_t* font, char chr);
-int8_t font_get_glyph(
-    U8G2FontRender_t* font,
-    U8G2FontGlyph_t* glyph,
-    uint16_t search_position,
-    char chr);
+uint16_t font_get_word(const uint8_t* data);
+int8_t font_get_glyph(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph, uint16_t encoding);
 void font_parse_glyph_header(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph);
 uint8_t font_draw_start_x_position(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph);
 uint8_t font_draw_start_y_position(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph);
+void font_render_run(
+    U8G2FontRender_t* font,
+    U8G2FontGlyph_t* glyph,
+    fnDrawSpan draw_span,
+    uint8_t length,
+    uint8_t x,
+    uint8_t y,
+    uint8_t* column,
+    uint8_t* row);
+void font_render_glyph_box(
+    U8G2FontRender_t* font,
+    U8G2FontGlyph_t* glyph,
+    uint8_t x_pos,
+    uint8_t y_pos);
 void font_render_glyph(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph, uint8_t x, uint8_t y);
 
+void U8G2FontIndex_Init(U8G2FontIndex_t* index, const uint8_t* data) {
+    memset(index, 0, sizeof(U8G2FontIndex_t));
+    index->data = data;
+    index->header = U8G2FontRender_ParseHeader(data);
+
+    // Glyphs below 0x100 are a linked list of records: encoding, record size, bitstream
+    uint16_t position = U8G2_FONT_HEADER_SIZE;
+    while(data[position + 1] != 0) {
+        index->glyph_offset[data[position]] = position;
+        position += data[position + 1];
+    }
+
+    // Jump table entries: block size in bytes, last encoding in block. Ends with 0xFFFF.
+    const uint8_t* table = data + index->header.offset_0x100;
+    uint16_t count = 0;
+    do {
+        count++;
+    } while(font_get_word(table + (count - 1) * 4 + 2) != 0xFFFF);
+
+    index->unicode_block_count = count;
+    index->unicode_block_offset = malloc(count * sizeof(uint16_t));
+    index->unicode_block_last = malloc(count * sizeof(uint16_t));
+
+    position = index->header.offset_0x100;
+    for(uint16_t i = 0; i < count; i++) {
+        position += font_get_word(table + i * 4);
+        index->unicode_block_offset[i] = position;
+        index->unicode_block_last[i] = font_get_word(table + i * 4 + 2);
+    }
+}
+
+void U8G2FontIndex_Deinit(U8G2FontIndex_t* index) {
+    free(index->unicode_block_offset);
+    free(index->unicode_block_last);
+    index->unicode_block_offset = NULL;
+    index->unicode_block_last = NULL;
+    index->unicode_block_count = 0;
+}
+
+const uint8_t* U8G2FontIndex_GetGlyph(const U8G2FontIndex_t* index, uint16_t encoding) {
+    if(encoding < U8G2_FONT_INDEX_SIZE) {
+        uint16_t offset = index->glyph_offset[encoding];
+        return offset ? index->data + offset + 2 : NULL;
+    }
+
+    // Binary search for the first block that may contain the encoding
+    uint16_t low = 0;
+    uint16_t high = index->unicode_block_count;
+    while(low < high) {
+        uint16_t middle = low + (high - low) / 2;
+        if(index->unicode_block_last[middle] < encoding) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if(low == index->unicode_block_count) {
+        return NULL;
+    }
+
+    // Unicode records: 2 byte encoding, record size, bitstream. Ends with zero encoding.
+    const uint8_t* glyph = index->data + index->unicode_block_offset[low];
+    while(1) {
+        uint16_t glyph_encoding = font_get_word(glyph);
+        if(glyph_encoding == 0 || glyph[2] == 0) {
+            break;
+        }
+        if(glyph_encoding == encoding) {
+            return glyph + 3;
+        }
+        glyph += glyph[2];
+    }
+
+    return NULL;
+}
+
 U8G2FontRender_t U8G2FontRender(
-    const uint8_t* data,
-    fnDrawPixel drawFgPixel,
-    fnDrawPixel drawBgPixel,
+    const U8G2FontIndex_t* index,
+    fnDrawSpan drawFgSpan,
+    fnDrawSpan drawBgSpan,
     void* context) {
     U8G2FontRender_t font = {
-        .data = data,
-        .drawFgPixel = drawFgPixel,
-        .drawBgPixel = drawBgPixel,
+        .index = index,
+        .header = &index->header,
+        .data = index->data,
+        .drawFgSpan = drawFgSpan,
+        .drawBgSpan = drawBgSpan,
         .context = context,
     };
 
-    font.header = U8G2FontRender_ParseHeader(&font);
-
     return font;
 }
 
-U8G2FontHeader_t U8G2FontRender_ParseHeader(U8G2FontRender_t* font) {
+U8G2FontHeader_t U8G2FontRender_ParseHeader(const uint8_t* data) {
     U8G2FontHeader_t header;
 
-    memcpy(&header, font->data, U8G2_FONT_HEADER_SIZE);
-    header.offset_A = U8G2_FONT_HEADER_SIZE + (font->data[17] << 8 | font->data[18]);
-    header.offset_a = U8G2_FONT_HEADER_SIZE + (font->data[19] << 8 | font->data[20]);
-    header.offset_0x100 = U8G2_FONT_HEADER_SIZE + (font->data[21] << 8 | font->data[22]);
+    memcpy(&header, data, U8G2_FONT_HEADER_SIZE);
+    header.offset_A = U8G2_FONT_HEADER_SIZE + (data[17] << 8 | data[18]);
+    header.offset_a = U8G2_FONT_HEADER_SIZE + (data[19] << 8 | data[20]);
+    header.offset_0x100 = U8G2_FONT_HEADER_SIZE + (data[21] << 8 | data[22]);
 
     return header;
 }
 
-void U8G2FontRender_PrintChar(U8G2FontRender_t* font, uint8_t* x, uint8_t y, char chr) {
-    uint16_t search_position = font_get_start_symbol_search_postition(font, chr);
+uint16_t U8G2FontRender_NextCodePoint(const char** str) {
+    const uint8_t* text = (const uint8_t*)*str;
+    uint16_t encoding = text[0];
+    uint8_t length = 1;
+
+    if((text[0] & 0xE0) == 0xC0 && (text[1] & 0xC0) == 0x80) {
+        encoding = (text[0] & 0x1F) << 6 | (text[1] & 0x3F);
+        length = 2;
+    } else if(
+        (text[0] & 0xF0) == 0xE0 && (text[1] & 0xC0) == 0x80 && (text[2] & 0xC0) == 0x80) {
+        encoding = (text[0] & 0x0F) << 12 | (text[1] & 0x3F) << 6 | (text[2] & 0x3F);
+        length = 3;
+    } else if(
+        (text[0] & 0xF8) == 0xF0 && (text[1] & 0xC0) == 0x80 && (text[2] & 0xC0) == 0x80 &&
+        (text[3] & 0xC0) == 0x80) {
+        // Outside of 16 bit u8g2 encoding range
+        encoding = 0xFFFF;
+        length = 4;
+    }
+    // Anything else is not valid UTF-8 and is taken as a single Latin-1 byte
+
+    *str += length;
+    return encoding;
+}
+
+uint8_t U8G2FontRender_DecodeGlyph(
+    U8G2FontRender_t* font,
+    uint16_t encoding,
+    U8G2FontGlyph_t* glyph) {
+    if(font_get_glyph(font, glyph, encoding) != U8G2FontRender_OK) {
+        return U8G2FontRender_ERR;
+    }
+    font_parse_glyph_header(font, glyph);
+
+    // Spans are relative to the top left corner of the glyph box
+    if(glyph->width && glyph->height) {
+        font_render_glyph_box(font, glyph, 0, 0);
+    }
+
+    return U8G2FontRender_OK;
+}
 
+void U8G2FontRender_PrintChar(U8G2FontRender_t* font, uint8_t* x, uint8_t y, uint16_t encoding) {
     U8G2FontGlyph_t glyph;
-    if(font_get_glyph(font, &glyph, search_position, chr) != U8G2FontRender_OK) {
+    if(font_get_glyph(font, &glyph, encoding) != U8G2FontRender_OK) {
         return;
     }
     font_parse_glyph_header(font, &glyph);
 
-    font_render_glyph(font, &glyph, *x, y);
+    if(glyph.width && glyph.height) {
+        font_render_glyph(font, &glyph, *x, y);
+    }
 
     *x += glyph.pitch;
 }
 
 void U8G2FontRender_Print(U8G2FontRender_t* font, uint8_t x, uint8_t y, const char* str) {
     while(*str) {
-        const char* chr = str++;
-        // if(*chr < 0x100) {
-        U8G2FontRender_PrintChar(font, &x, y, *chr);
-        // }
+        uint16_t encoding = U8G2FontRender_NextCodePoint(&str);
+        U8G2FontRender_PrintChar(font, &x, y, encoding);
     }
 }
 
@@ -101,46 +227,29 @@ int8_t font_get_signed_bits(U8G2FontGlyph_t* glyph, uint8_t count) {
     return val;
 }
 
-uint16_t font_get_start_symbol_search_postition(U8G2FontRender_t* font, char chr) {
-    uint16_t search_position = U8G2_FONT_HEADER_SIZE;
-    if(chr >= 65 && chr <= 90) {
-        search_position = font->header.offset_A;
-    } else if(chr >= 97 && chr <= 122) {
-        search_position = font->header.offset_a;
-    }
-
-    return search_position;
+uint16_t font_get_word(const uint8_t* data) {
+    return pgm_read(data) << 8 | pgm_read(data + 1);
 }
 
-int8_t font_get_glyph(
-    U8G2FontRender_t* font,
-    U8G2FontGlyph_t* glyph,
-    uint16_t search_position,
-    char chr) {
-    while(1) {
-        memcpy(glyph, font->data + search_position, 2);
-        if(glyph->character == chr) {
-            glyph->data = font->data + search_position + 2;
-            glyph->bit_pos = 0;
-
-            return U8G2FontRender_OK;
-        }
-
-        search_position += glyph->next_glypth;
-        if(glyph->next_glypth == 0) {
-            break;
-        }
+int8_t font_get_glyph(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph, uint16_t encoding) {
+    const uint8_t* data = U8G2FontIndex_GetGlyph(font->index, encoding);
+    if(data == NULL) {
+        return U8G2FontRender_ERR;
     }
 
-    return U8G2FontRender_ERR;
+    glyph->character = encoding;
+    glyph->data = data;
+    glyph->bit_pos = 0;
+
+    return U8G2FontRender_OK;
 }
 
 void font_parse_glyph_header(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph) {
-    glyph->width = font_get_unsigned_bits(glyph, font->header.glyph_width);
-    glyph->height = font_get_unsigned_bits(glyph, font->header.glyph_height);
-    glyph->x_offset = font_get_signed_bits(glyph, font->header.glyph_x_offset);
-    glyph->y_offset = font_get_signed_bits(glyph, font->header.glyph_y_offset);
-    glyph->pitch = font_get_signed_bits(glyph, font->header.glyph_pitch);
+    glyph->width = font_get_unsigned_bits(glyph, font->header->glyph_width);
+    glyph->height = font_get_unsigned_bits(glyph, font->header->glyph_height);
+    glyph->x_offset = font_get_signed_bits(glyph, font->header->glyph_x_offset);
+    glyph->y_offset = font_get_signed_bits(glyph, font->header->glyph_y_offset);
+    glyph->pitch = font_get_signed_bits(glyph, font->header->glyph_pitch);
 }
 
 uint8_t font_draw_start_x_position(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph) {
@@ -151,13 +260,43 @@ uint8_t font_draw_start_y_position(U8G2FontRender_t* font, U8G2FontGlyph_t* glyp
     return -glyph->height - glyph->y_offset;
 }
 
-void font_render_glyph(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph, uint8_t x, uint8_t y) {
-    uint32_t pixels = 0;
-    uint8_t y_pos = y + font_draw_start_y_position(font, glyph);
-    uint8_t x_pos = x + font_draw_start_x_position(font, glyph);
-    while(1) {
-        uint8_t zeros = font_get_unsigned_bits(glyph, font->header.zero_bit_width);
-        uint8_t ones = font_get_unsigned_bits(glyph, font->header.one_bit_width);
+void font_render_run(
+    U8G2FontRender_t* font,
+    U8G2FontGlyph_t* glyph,
+    fnDrawSpan draw_span,
+    uint8_t length,
+    uint8_t x,
+    uint8_t y,
+    uint8_t* column,
+    uint8_t* row) {
+    // Split run on glyph row boundaries, each part is a single span
+    while(length > 0 && *row < glyph->height) {
+        uint8_t span = glyph->width - *column;
+        if(span > length) {
+            span = length;
+        }
+
+        draw_span(x + *column, y + *row, span, font->context);
+
+        length -= span;
+        *column += span;
+        if(*column == glyph->width) {
+            *column = 0;
+            (*row)++;
+        }
+    }
+}
+
+void font_render_glyph_box(
+    U8G2FontRender_t* font,
+    U8G2FontGlyph_t* glyph,
+    uint8_t x_pos,
+    uint8_t y_pos) {
+    uint8_t column = 0;
+    uint8_t row = 0;
+    while(row < glyph->height) {
+        uint8_t zeros = font_get_unsigned_bits(glyph, font->header->zero_bit_width);
+        uint8_t ones = font_get_unsigned_bits(glyph, font->header->one_bit_width);
         int8_t repeat = 0;
 
         while(font_get_unsigned_bits(glyph, 1) == 1) {
@@ -165,24 +304,14 @@ void font_render_glyph(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph, uint8_t x
         }
 
         for(; repeat >= 0; repeat--) {
-            for(uint8_t i = 0; i < zeros + ones; i++) {
-                if(i <= zeros - 1) {
-                    font->drawBgPixel(x_pos, y_pos, font->context);
-                } else {
-                    font->drawFgPixel(x_pos, y_pos, font->context);
-                }
-                x_pos++;
-
-                pixels++;
-                if(pixels % glyph->width == 0) {
-                    y_pos++;
-                    x_pos = x + font_draw_start_x_position(font, glyph);
-                }
-            }
-        }
-
-        if(pixels >= glyph->width * glyph->height) {
-            break;
+            font_render_run(font, glyph, font->drawBgSpan, zeros, x_pos, y_pos, &column, &row);
+            font_render_run(font, glyph, font->drawFgSpan, ones, x_pos, y_pos, &column, &row);
         }
     }
+}
+
+void font_render_glyph(U8G2FontRender_t* font, U8G2FontGlyph_t* glyph, uint8_t x, uint8_t y) {
+    uint8_t y_pos = y + font_draw_start_y_position(font, glyph);
+    uint8_t x_pos = x + font_draw_start_x_position(font, glyph);
+    font_render_glyph_box(font, glyph, x_pos, y_pos);
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #ifndef INC_U8G2_FONT_RENDER_H_
 #define INC_U8G2_FONT_RENDER_H_
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,13 +17,15 @@ extern "C" {
 #endif
 
 #define U8G2_FONT_HEADER_SIZE 23
+#define U8G2_FONT_INDEX_SIZE 0x100
 
 #define U8G2FontRender_OK 0x01
 #define U8G2FontRender_ERR 0x02
 
 #define pgm_read(adr) (*(const uint8_t*)(adr))
 
-typedef void (*fnDrawPixel)(uint8_t x, uint8_t y, void* context);
+/* Draws `length` pixels of a glyph row starting at x, y and going right */
+typedef void (*fnDrawSpan)(uint8_t x, uint8_t y, uint8_t length, void* context);
 
 typedef struct {
     uint8_t number_of_glyphs : 8;
@@ -52,8 +55,7 @@ typedef struct {
 } U8G2FontHeader_t;
 
 typedef struct {
-    uint8_t character : 8;
-    uint8_t next_glypth : 8;
+    uint16_t character;
 
     uint8_t width;
     uint8_t height;
@@ -65,23 +67,48 @@ typedef struct {
     const uint8_t* data;
 } U8G2FontGlyph_t;
 
+/* Parsed font header and glyph lookup tables, built once per font */
 typedef struct {
     U8G2FontHeader_t header;
 
     const uint8_t* data;
 
-    fnDrawPixel drawFgPixel;
-    fnDrawPixel drawBgPixel;
+    /* Offset of glyph record from font start for code points below 0x100, 0 if absent */
+    uint16_t glyph_offset[U8G2_FONT_INDEX_SIZE];
+
+    /* Unicode jump table: block start offsets and last code point of each block */
+    uint16_t unicode_block_count;
+    uint16_t* unicode_block_offset;
+    uint16_t* unicode_block_last;
+} U8G2FontIndex_t;
+
+typedef struct {
+    const U8G2FontIndex_t* index;
+    const U8G2FontHeader_t* header;
+
+    const uint8_t* data;
+
+    fnDrawSpan drawFgSpan;
+    fnDrawSpan drawBgSpan;
     void* context;
 } U8G2FontRender_t;
 
+void U8G2FontIndex_Init(U8G2FontIndex_t* index, const uint8_t* data);
+void U8G2FontIndex_Deinit(U8G2FontIndex_t* index);
+const uint8_t* U8G2FontIndex_GetGlyph(const U8G2FontIndex_t* index, uint16_t encoding);
+
 U8G2FontRender_t U8G2FontRender(
-    const uint8_t* data,
-    fnDrawPixel drawFgPixel,
-    fnDrawPixel drawBgPixel,
+    const U8G2FontIndex_t* index,
+    fnDrawSpan drawFgSpan,
+    fnDrawSpan drawBgSpan,
     void* context);
-U8G2FontHeader_t U8G2FontRender_ParseHeader(U8G2FontRender_t* font);
-void U8G2FontRender_PrintChar(U8G2FontRender_t* font, uint8_t* x, uint8_t y, char chr);
+U8G2FontHeader_t U8G2FontRender_ParseHeader(const uint8_t* data);
+uint16_t U8G2FontRender_NextCodePoint(const char** str);
+uint8_t U8G2FontRender_DecodeGlyph(
+    U8G2FontRender_t* font,
+    uint16_t encoding,
+    U8G2FontGlyph_t* glyph);
+void U8G2FontRender_PrintChar(U8G2FontRender_t* font, uint8_t* x, uint8_t y, uint16_t encoding);
 void U8G2FontRender_Print(U8G2FontRender_t* font, uint8_t x, uint8_t y, const char* str);
 
 #ifdef __cplusplus
@@ -0,0 +1,160 @@
+#include "icon_cache.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <string.h>
+
+// Heatshrink parameters the firmware asset compiler uses
+static constexpr size_t HEATSHRINK_WINDOW_BITS = 8;
+static constexpr size_t HEATSHRINK_LOOKAHEAD_BITS = 4;
+static constexpr size_t COMPRESS_HEADER_SIZE = 4;
+
+// Reads heatshrink bitfields, MSB first
+class HeatshrinkReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position = 0;
+
+public:
+    HeatshrinkReader(const uint8_t* data, size_t size)
+        : data(data)
+        , size(size) {
+    }
+
+    // -1 when the stream ends
+    int get(size_t count) {
+        if(position + count > size * 8) return -1;
+        int value = 0;
+        for(size_t i = 0; i < count; i++, position++) {
+            value = value << 1 | ((data[position / 8] >> (7 - position % 8)) & 1);
+        }
+        return value;
+    }
+};
+
+// Decodes until the output is full or the input ends, bytes before the output start are zero
+static void heatshrink_decode(
+    const uint8_t* input,
+    size_t input_size,
+    uint8_t* output,
+    size_t output_size) {
+    HeatshrinkReader reader(input, input_size);
+    size_t position = 0;
+    while(position < output_size) {
+        int tag = reader.get(1);
+        if(tag < 0) break;
+
+        if(tag) {
+            int literal = reader.get(8);
+            if(literal < 0) break;
+            output[position++] = literal;
+        } else {
+            int index = reader.get(HEATSHRINK_WINDOW_BITS);
+            int count = reader.get(HEATSHRINK_LOOKAHEAD_BITS);
+            if(index < 0 || count < 0) break;
+            size_t offset = index + 1;
+            for(int i = 0; i <= count && position < output_size; i++, position++) {
+                output[position] = position >= offset ? output[position - offset] : 0;
+            }
+        }
+    }
+    memset(output + position, 0, output_size - position);
+}
+
+// Least recently used frames, front of the list is the newest
+class IconCache {
+private:
+    struct Frame {
+        const uint8_t* data;
+        std::shared_ptr<const uint8_t[]> bitmap;
+        size_t size;
+    };
+
+    std::mutex mutex;
+    std::list<Frame> frames;
+    std::unordered_map<const uint8_t*, std::list<Frame>::iterator> index;
+    size_t budget = ICON_CACHE_BUDGET;
+    size_t bytes_used = 0;
+    size_t hits = 0;
+    size_t decodes = 0;
+    size_t bytes_decoded = 0;
+    size_t evictions = 0;
+
+    // Keeps the newest frame even if it alone is over budget
+    void trim() {
+        while(bytes_used > budget && frames.size() > 1) {
+            bytes_used -= frames.back().size;
+            index.erase(frames.back().data);
+            frames.pop_back();
+            evictions++;
+        }
+    }
+
+public:
+    std::shared_ptr<const uint8_t[]> get(const uint8_t* data, uint8_t width, uint8_t height) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(data);
+        if(it != index.end()) {
+            frames.splice(frames.begin(), frames, it->second);
+            hits++;
+            return it->second->bitmap;
+        }
+
+        size_t size = (width + 7) / 8 * height;
+        size_t compressed_size = data[2] | data[3] << 8;
+        std::shared_ptr<uint8_t[]> bitmap = std::make_shared<uint8_t[]>(size);
+        heatshrink_decode(data + COMPRESS_HEADER_SIZE, compressed_size, bitmap.get(), size);
+        decodes++;
+        bytes_decoded += size;
+
+        frames.push_front({data, bitmap, size});
+        index.emplace(data, frames.begin());
+        bytes_used += size;
+        trim();
+        return bitmap;
+    }
+
+    void set_budget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = bytes;
+        trim();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        index.clear();
+        frames.clear();
+        bytes_used = 0;
+    }
+
+    void get_stats(IconCacheStats* stats) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats->frames = frames.size();
+        stats->bytes_used = bytes_used;
+        stats->budget = budget;
+        stats->hits = hits;
+        stats->decodes = decodes;
+        stats->bytes_decoded = bytes_decoded;
+        stats->evictions = evictions;
+    }
+};
+
+static IconCache icon_cache;
+
+std::shared_ptr<const uint8_t[]>
+    icon_cache_get(const uint8_t* data, uint8_t width, uint8_t height) {
+    return icon_cache.get(data, width, height);
+}
+
+void icon_cache_set_budget(size_t bytes) {
+    icon_cache.set_budget(bytes);
+}
+
+void icon_cache_clear() {
+    icon_cache.clear();
+}
+
+void icon_cache_get_stats(IconCacheStats* stats) {
+    icon_cache.get_stats(stats);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+
+#ifndef ICON_CACHE_BUDGET
+#define ICON_CACHE_BUDGET (64 * 1024)
+#endif
+
+typedef struct {
+    size_t frames; // decoded frames held
+    size_t bytes_used; // decoded bytes held
+    size_t budget; // limit of `bytes_used`
+    size_t hits;
+    size_t decodes; // frames decompressed, a frame decoded again was evicted in between
+    size_t bytes_decoded; // sum of decoded frame sizes
+    size_t evictions;
+} IconCacheStats;
+
+/** Get XBM bitmap of a heatshrink compressed icon frame
+ * Frames are decoded on first use and kept while they are among the most recently used ones
+ * that fit into the memory budget.
+ *
+ * @param      data    compressed bitmap data, starting with the compression header
+ * @param      width   frame width
+ * @param      height  frame height
+ *
+ * @return     XBM bitmap, stays valid while held even if evicted
+ */
+std::shared_ptr<const uint8_t[]>
+    icon_cache_get(const uint8_t* data, uint8_t width, uint8_t height);
+
+/** Set decoded frame memory budget, least recently used frames are dropped to fit
+ *
+ * @param      bytes   budget in bytes
+ */
+void icon_cache_set_budget(size_t bytes);
+
+/** Drop all decoded frames
+ */
+void icon_cache_clear();
+
+/** Get decoded frame cache counters, shared by all canvases
+ *
+ * @param      stats  stats to fill
+ */
+void icon_cache_get_stats(IconCacheStats* stats);
\ No newline at end of file
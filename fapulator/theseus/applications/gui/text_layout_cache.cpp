@@ -0,0 +1,95 @@
+#include "text_layout_cache.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+struct TextLayoutKeyHash {
+    size_t operator()(const TextLayoutKey& key) const {
+        uint64_t hash = key.hash;
+        hash = hash * 31 + (uintptr_t)key.text;
+        hash = hash * 31 + (uintptr_t)key.font;
+        hash = hash * 31 + ((uint64_t)key.mode << 32 | (uint64_t)key.width << 16 | key.lines);
+        return hash;
+    }
+};
+
+// Least recently used layouts, front of the list is the newest
+class TextLayoutCache {
+private:
+    static constexpr size_t CAPACITY = 64;
+
+    typedef std::pair<TextLayoutKey, std::shared_ptr<const TextLayout>> Entry;
+
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<TextLayoutKey, std::list<Entry>::iterator, TextLayoutKeyHash> index;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+public:
+    std::shared_ptr<const TextLayout>
+        get(const TextLayoutKey& key, const std::function<void(TextLayout&)>& build) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if(it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            hits++;
+            return it->second->second;
+        }
+
+        auto layout = std::make_shared<TextLayout>();
+        layout->width = 0;
+        layout->truncated = false;
+        build(*layout);
+        misses++;
+
+        if(entries.size() == CAPACITY) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+            evictions++;
+        }
+        entries.emplace_front(key, layout);
+        index.emplace(key, entries.begin());
+        return layout;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        index.clear();
+        entries.clear();
+    }
+
+    void get_stats(TextLayoutCacheStats* stats) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats->layouts = entries.size();
+        stats->hits = hits;
+        stats->misses = misses;
+        stats->evictions = evictions;
+    }
+};
+
+static TextLayoutCache text_layout_cache;
+
+// FNV-1a
+uint64_t text_layout_hash(const char* text) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(; *text; text++) {
+        hash = (hash ^ (uint8_t)*text) * 0x100000001b3;
+    }
+    return hash;
+}
+
+std::shared_ptr<const TextLayout> text_layout_cache_get(
+    const TextLayoutKey& key,
+    const std::function<void(TextLayout&)>& build) {
+    return text_layout_cache.get(key, build);
+}
+
+void text_layout_cache_clear() {
+    text_layout_cache.clear();
+}
+
+void text_layout_cache_get_stats(TextLayoutCacheStats* stats) {
+    text_layout_cache.get_stats(stats);
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Line breaking rules, each one caches its own layouts
+enum class TextLayoutMode : uint8_t {
+    Lines, // split on new lines only
+    Aligned, // elements_multiline_text_aligned breaking
+    WordWrap, // elements_text_box breaking
+};
+
+struct TextLayoutKey {
+    const char* text;
+    uint64_t hash; // text_layout_hash of `text`
+    const uint8_t* font;
+    TextLayoutMode mode;
+    uint16_t width; // line width in pixels, 0 for unlimited
+    uint16_t lines; // maximum number of lines, 0 for unlimited
+
+    bool operator==(const TextLayoutKey& other) const = default;
+};
+
+struct TextLayoutLine {
+    std::string text; // line text, ends with a dash if the line was broken inside a paragraph
+    uint16_t width; // width of `text` in pixels
+    bool broken; // line ends inside a paragraph
+};
+
+struct TextLayout {
+    std::vector<TextLayoutLine> lines;
+    uint16_t width; // widest line in pixels
+    bool truncated; // text did not fit into the maximum number of lines
+    std::string ellipsis; // last line shortened to end with "...", set if truncated
+};
+
+typedef struct {
+    size_t layouts;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} TextLayoutCacheStats;
+
+/** Hash text content for TextLayoutKey
+ *
+ * @param      text    C-string
+ *
+ * @return     content hash
+ */
+uint64_t text_layout_hash(const char* text);
+
+/** Get text layout
+ * Layouts are kept for the most recently used keys, `build` runs only when the key is not cached.
+ * Text that changes in place gets a different hash, so the pointer and content both have to
+ * match.
+ *
+ * @param      key     layout key
+ * @param      build   fills a layout for the key
+ *
+ * @return     layout, stays valid while held even if evicted
+ */
+std::shared_ptr<const TextLayout> text_layout_cache_get(
+    const TextLayoutKey& key,
+    const std::function<void(TextLayout&)>& build);
+
+/** Drop all cached layouts
+ */
+void text_layout_cache_clear();
+
+/** Get layout cache counters, shared by all canvases
+ *
+ * @param      stats  stats to fill
+ */
+void text_layout_cache_get_stats(TextLayoutCacheStats* stats);
\ No newline at end of file
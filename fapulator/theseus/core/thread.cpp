@@ -28,6 +28,7 @@ private:
     std::thread thread;
     std::string name;
     FuriThreadCallback callback;
+    void* context = NULL;
     FuriEventFlag* event_flag;
     size_t stack_size;
     FuriThread* thread_ptr;
@@ -36,7 +37,7 @@ private:
         ThreadInstance* instance = (ThreadInstance*)context;
         thread_map_push(std::this_thread::get_id(), instance->thread_ptr);
 
-        instance->callback(NULL);
+        instance->callback(instance->context);
         thread_map_erase(std::this_thread::get_id());
     }
 
@@ -58,6 +59,10 @@ public:
         this->callback = callback;
     }
 
+    void set_context(void* context) {
+        this->context = context;
+    }
+
     void set_stack_size(size_t stack_size) {
         this->stack_size = stack_size;
     }
@@ -106,6 +111,10 @@ void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback) {
     thread->instance->set_callback(callback);
 }
 
+void furi_thread_set_context(FuriThread* thread, void* context) {
+    thread->instance->set_context(context);
+}
+
 void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size) {
     thread->instance->set_stack_size(stack_size);
 }
@@ -114,6 +123,10 @@ void furi_thread_start(FuriThread* thread) {
     thread->instance->start();
 }
 
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return (FuriThreadId)thread;
+}
+
 FuriThreadId furi_thread_get_current_id() {
     std::thread::id id = std::this_thread::get_id();
     FuriThread* thread = thread_map_get(id);
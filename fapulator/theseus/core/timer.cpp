@@ -1,45 +1,64 @@
 #include <core/timer.h>
+#include <atomic>
+#include <memory>
 #include <thread>
 
 class TimerInstance {
 private:
+    // One per start, a stopped run's thread only touches its own state so it can finish after
+    // the timer was restarted or freed from its callback
+    struct Run {
+        std::atomic<bool> continued = true;
+        FuriTimerCallback callback;
+        void* context;
+        uint32_t ticks;
+    };
+
     std::thread thread;
-    bool continued;
+    std::shared_ptr<Run> run;
     FuriTimerCallback callback;
     void* context;
-    uint32_t ticks;
 
-    void run() {
-        do {
-            std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
-            callback(context);
-        } while(continued);
+    static void run_thread(std::shared_ptr<Run> run) {
+        while(run->continued) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(run->ticks));
+            if(!run->continued) break;
+            run->callback(run->context);
+        }
     }
 
 public:
     TimerInstance(FuriTimerCallback callback, void* context)
         : callback(callback)
         , context(context) {
-        continued = true;
     }
 
     ~TimerInstance() {
-        continued = false;
-        thread.join();
+        stop();
     }
 
     void start(uint32_t ticks) {
-        this->ticks = ticks;
-        thread = std::thread(&TimerInstance::run, this);
+        stop();
+        run = std::make_shared<Run>();
+        run->callback = callback;
+        run->context = context;
+        run->ticks = ticks;
+        thread = std::thread(run_thread, run);
     }
 
+    // Waits for the pending period, unless called from the callback
     void stop() {
-        continued = false;
-        thread.join();
+        if(run) run->continued = false;
+        if(!thread.joinable()) return;
+        if(thread.get_id() == std::this_thread::get_id()) {
+            thread.detach();
+        } else {
+            thread.join();
+        }
     }
 
     bool is_running() {
-        return continued;
+        return run && run->continued;
     }
 };
 